@@ -0,0 +1,51 @@
+#!/bin/bash
+# hw2 的 size sweep benchmark
+# 用法: ./bench.sh [cell 數 ...]  (預設 10000 100000 1000000)
+#   GEN_ARGS: 額外傳給 gen_netlist 的參數 (例如 "--degree fixed:3 --fill 0.95")
+#   HW2_ARGS: 額外傳給 hw2 的參數 (例如 "--multilevel")
+#   BENCH_CSV: 結果 CSV 的路徑 (預設 bench_results.csv)
+# 每個大小先用 gen_netlist 產生 netlist，再跑 hw2，記錄 wall time、peak RSS 與 CutSize
+
+BIN_DIR="$(cd "$(dirname "$0")/../bin" && pwd)"
+GEN="$BIN_DIR/gen_netlist"
+HW2="$BIN_DIR/hw2"
+CSV_FILE="${BENCH_CSV:-bench_results.csv}"
+SIZES="${*:-10000 100000 1000000}"
+
+for exe in "$GEN" "$HW2"; do
+    if [ ! -x "$exe" ]; then
+        echo "Cannot find $exe (run make hw2 gen_netlist first)" >&2
+        exit 1
+    fi
+done
+
+# 產生的 netlist 與輸出檔放在暫存目錄，結束時刪掉
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+echo "Cells,Nets,Pins,GenTime(s),Time(s),PeakRSS(KB),CutSize" > "$CSV_FILE"
+printf "%10s %10s %10s %10s %10s %12s %10s\n" Cells Nets Pins GenTime Time "PeakRSS(KB)" CutSize
+
+for n in $SIZES; do
+    IN="$WORK_DIR/gen_$n.txt"
+    OUT="$WORK_DIR/gen_$n.out"
+    LOG="$WORK_DIR/gen_$n.log"
+
+    start=$(date +%s.%N)
+    "$GEN" "$IN" --cells "$n" $GEN_ARGS || exit 1
+    gen_time=$(awk -v s="$start" -v e="$(date +%s.%N)" 'BEGIN {print e - s}')
+
+    start=$(date +%s.%N)
+    "$HW2" "$IN" "$OUT" $HW2_ARGS > "$LOG" 2>&1 || { echo "hw2 failed on $n cells:" >&2; tail "$LOG" >&2; exit 1; }
+    run_time=$(awk -v s="$start" -v e="$(date +%s.%N)" 'BEGIN {print e - s}')
+
+    nets=$(awk '/^NumNets/ {print $2}' "$IN")
+    pins=$(grep -c '^Cell C[0-9]*$' "$IN")
+    rss=$(awk '/^Peak RSS:/ {print $3}' "$LOG")
+    cut=$(awk 'NR == 1 {print $2}' "$OUT")
+
+    printf "%10s %10s %10s %10.3f %10.3f %12s %10s\n" "$n" "$nets" "$pins" "$gen_time" "$run_time" "$rss" "$cut"
+    echo "$n,$nets,$pins,$gen_time,$run_time,$rss,$cut" >> "$CSV_FILE"
+done
+
+echo "Results written to $CSV_FILE"
@@ -0,0 +1,73 @@
+#include <bits/stdc++.h>
+#include "lib.h"
+#include "hypergraph.h"
+#include "parser.h"
+using namespace std;
+
+/******************************************************
+  parse throughput benchmark
+  用法: ./bench_parse <txt file> [repeat]
+  1. mmap Parser 完整解析 (含建立 CSR) repeat 次
+  2. 對照組：同一個檔案用 getline + stringstream 只切 token 不建任何資料結構
+  兩者都取 repeat 次中最快的一次
+******************************************************/
+static double now()
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <txt file> [repeat]\n";
+        return 1;
+    }
+    string inFile = argv[1];
+    int repeat = argc > 2 ? max(1, atoi(argv[2])) : 10;
+
+    double bestParse = 1e30;
+    size_t bytes = 0;
+    int numCells = 0, numNets = 0;
+    size_t numPins = 0;
+    for (int r = 0; r < repeat; ++r) {
+        double t0 = now();
+        map<string, vector<LibraryCell>> techLibCells;
+        vector<Die> dies;
+        Hypergraph hg;
+        vector<Cell> cells;
+        Parser parser(inFile);
+        parser.parse(techLibCells, hg, cells, dies);
+        double t = now() - t0;
+        bestParse = min(bestParse, t);
+        bytes = parser.fileSize();
+        numCells = hg.numCells;
+        numNets = hg.numNets;
+        numPins = hg.netCells.size();
+    }
+
+    double bestStream = 1e30;
+    size_t tokens = 0;
+    for (int r = 0; r < repeat; ++r) {
+        double t0 = now();
+        ifstream fin(inFile);
+        string line, tok;
+        tokens = 0;
+        while (getline(fin, line)) {
+            stringstream ss(line);
+            while (ss >> tok)
+                ++tokens;
+        }
+        bestStream = min(bestStream, now() - t0);
+    }
+
+    double mb = bytes / 1048576.0;
+    cout << "file: " << inFile << " (" << bytes << " bytes, " << numCells << " cells, "
+         << numNets << " nets, " << numPins << " pins)" << endl;
+    cout << fixed << setprecision(4);
+    cout << "mmap parser:            " << bestParse << " s, " << setprecision(1) << mb / bestParse << " MB/s, "
+         << numPins / bestParse / 1e6 << " Mpins/s" << endl;
+    cout << setprecision(4);
+    cout << "getline + stringstream: " << bestStream << " s, " << setprecision(1) << mb / bestStream << " MB/s ("
+         << tokens << " tokens, tokenize only)" << endl;
+    return 0;
+}
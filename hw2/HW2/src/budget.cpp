@@ -0,0 +1,38 @@
+#include <bits/stdc++.h>
+#include "budget.h"
+using namespace std;
+
+TimeBudget::TimeBudget(double limit)
+    : startTime(Clock::now()), secPerUnit(initialSecPerUnit)
+{
+    deadline = startTime + chrono::duration_cast<Clock::duration>(chrono::duration<double>(max(0.0, limit)));
+}
+
+void TimeBudget::reserve(double seconds)
+{
+    deadline -= chrono::duration_cast<Clock::duration>(chrono::duration<double>(seconds));
+}
+
+double TimeBudget::elapsed() const
+{
+    return chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+double TimeBudget::remaining() const
+{
+    return chrono::duration<double>(deadline - Clock::now()).count();
+}
+
+// 取這次量到的速度，但不會一下子降到前一次的一半以下，避免一次特別快的量測讓預估太樂觀
+void TimeBudget::record(double work, double seconds)
+{
+    if (work <= 0)
+        return;
+    double measured = seconds / work;
+    secPerUnit = max(measured, 0.5 * secPerUnit);
+}
+
+double TimeBudget::estimate(double work) const
+{
+    return work * secPerUnit;
+}
@@ -0,0 +1,44 @@
+#ifndef BUDGET_H
+#define BUDGET_H
+
+#include <chrono>
+
+using namespace std;
+
+/************************************
+ * TimeBudget:
+ *   整個程式的時間預算，以 steady_clock (wall-clock) 計時，
+ *   多個 thread 同時跑時也正確 (clock() 會把所有 thread 的 CPU 時間加起來)
+ *   從建構時開始計時，limit 秒後 expired()；reserve() 預留寫檔的時間
+ *   另外記錄「每單位工作量要幾秒」，用來預估下一個 pass / V-cycle 放不放得下：
+ *   工作量以 cell 數 + pin 數計 (FM 一個 pass 大約正比於此)
+ ************************************/
+class TimeBudget {
+    public:
+        typedef chrono::steady_clock Clock;
+
+        explicit TimeBudget(double limit);
+
+        // 從總預算中扣掉 seconds 秒，留給最後寫檔
+        void reserve(double seconds);
+
+        double elapsed() const;
+        double remaining() const;
+        bool expired() const { return Clock::now() >= deadline; }
+
+        // 記錄一次實際花費：work 單位的工作用了 seconds 秒 (只在主 thread 呼叫)
+        void record(double work, double seconds);
+        // 預估 work 單位的工作要幾秒 / 剩下的時間夠不夠
+        double estimate(double work) const;
+        bool fits(double work) const { return estimate(work) <= remaining(); }
+
+    private:
+        // 還沒有量測時的每單位工作秒數 (刻意估高一點)
+        static constexpr double initialSecPerUnit = 1e-7;
+
+        Clock::time_point startTime;
+        Clock::time_point deadline;
+        double secPerUnit;
+};
+
+#endif // BUDGET_H
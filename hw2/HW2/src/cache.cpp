@@ -0,0 +1,343 @@
+#include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cache.h"
+using namespace std;
+
+static const char cacheMagic[8] = {'H', 'W', '2', 'C', 'A', 'C', 'H', 'E'};
+
+// 輸入檔的大小與修改時間 (ns)，cache 只在兩者都相同時有效
+static bool sourceStamp(const string &inFile, uint64_t &size, uint64_t &mtime)
+{
+    struct stat st;
+    if (stat(inFile.c_str(), &st) < 0)
+        return false;
+    size = st.st_size;
+    mtime = (uint64_t)st.st_mtim.tv_sec * 1000000000ULL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+// 依序寫出 cache 的各個欄位，任何一次寫入失敗 ok 就變成 false
+class CacheWriter {
+    public:
+        bool ok;
+
+        explicit CacheWriter(FILE *fp) : ok(true), fp(fp), offset(0) {}
+        void raw(const void *p, size_t n) {
+            if (n && fwrite(p, 1, n, fp) != n)
+                ok = false;
+            offset += n;
+        }
+        // 補 0 到 8 byte 的倍數
+        void pad() {
+            static const char zero[8] = {0};
+            raw(zero, (8 - offset % 8) % 8);
+        }
+        void u64(uint64_t v) { raw(&v, sizeof(v)); }
+        void f64(double v) { raw(&v, sizeof(v)); }
+        void str(string_view s) { u64(s.size()); raw(s.data(), s.size()); pad(); }
+        template<class T>
+        void array(const T *p, size_t n) { u64(n); raw(p, n * sizeof(T)); pad(); }
+
+    private:
+        FILE *fp;
+        size_t offset;
+};
+
+// 依寫出的順序讀回來，超出檔案範圍時 ok 變成 false (之後讀到的都是 0 / 空的)
+class CacheReader {
+    public:
+        bool ok;
+
+        CacheReader(const char *data, size_t size) : ok(true), base(data), cur(data), end(data + size) {}
+        const char *take(size_t n) {
+            if (!ok || (size_t)(end - cur) < n) {
+                ok = false;
+                return NULL;
+            }
+            const char *p = cur;
+            cur += n;
+            return p;
+        }
+        void pad() { take((8 - (cur - base) % 8) % 8); }
+        uint64_t u64() {
+            uint64_t v = 0;
+            if (const char *p = take(sizeof(v)))
+                memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        double f64() {
+            double v = 0;
+            if (const char *p = take(sizeof(v)))
+                memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        string_view str() {
+            uint64_t n = u64();
+            const char *p = take(n);
+            pad();
+            return p ? string_view(p, n) : string_view();
+        }
+        // 回傳指向 mmap 區域的陣列 (已對齊 8 byte)
+        template<class T>
+        const T *array(size_t &n) {
+            n = u64();
+            if (!ok || n > (size_t)(end - cur) / sizeof(T)) {
+                ok = false;
+                n = 0;
+                return NULL;
+            }
+            const T *p = (const T *)take(n * sizeof(T));
+            pad();
+            return p;
+        }
+        template<class T>
+        bool copy(vector<T> &v, size_t expected) {
+            size_t n;
+            const T *p = array<T>(n);
+            if (!ok || n != expected)
+                return ok = false;
+            v.assign(p, p + n);
+            return true;
+        }
+
+    private:
+        const char *base;
+        const char *cur;
+        const char *end;
+};
+
+// names[i] = blob[offset[i] .. offset[i+1])
+static bool readNames(CacheReader &in, size_t count, vector<string_view> &names)
+{
+    size_t numOffsets, blobSize;
+    const uint64_t *offset = in.array<uint64_t>(numOffsets);
+    const char *blob = in.array<char>(blobSize);
+    if (!in.ok || numOffsets != count + 1 || offset[count] != blobSize)
+        return false;
+    names.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (offset[i] > offset[i + 1])
+            return false;
+        names[i] = string_view(blob + offset[i], offset[i + 1] - offset[i]);
+    }
+    return true;
+}
+
+// CSR 的起點陣列：從 0 開始、不遞減、最後等於 pin 數
+static bool validStart(const vector<int> &start, size_t numPins)
+{
+    if (start.empty() || start[0] != 0 || (size_t)start.back() != numPins)
+        return false;
+    for (size_t i = 1; i < start.size(); ++i)
+        if (start[i] < start[i - 1])
+            return false;
+    return true;
+}
+
+static void writeNames(CacheWriter &out, const vector<string_view> &names)
+{
+    vector<uint64_t> offset(names.size() + 1, 0);
+    for (size_t i = 0; i < names.size(); ++i)
+        offset[i + 1] = offset[i] + names[i].size();
+    out.array(offset.data(), offset.size());
+    string blob;
+    blob.reserve(offset.back());
+    for (string_view name : names)
+        blob.append(name.data(), name.size());
+    out.array(blob.data(), blob.size());
+}
+
+
+
+NetlistCache::NetlistCache()
+    : data(NULL), size(0)
+{
+}
+
+NetlistCache::~NetlistCache()
+{
+    if (data)
+        munmap((void *)data, size);
+}
+
+bool NetlistCache::load(const string &cacheFile, const string &inFile, map<string, vector<LibraryCell>> &techLibCells,
+                        Hypergraph &hg, vector<Cell> &cells, vector<Die> &dies, int &numLibCells)
+{
+    PROFILE_SCOPE(PhaseParse);
+    uint64_t sourceSize, sourceMtime;
+    if (!sourceStamp(inFile, sourceSize, sourceMtime))
+        return false;
+    int fd = open(cacheFile.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return false;
+    data = (const char *)p;
+    size = st.st_size;
+
+    CacheReader in(data, size);
+    const char *magic = in.take(sizeof(cacheMagic));
+    bool valid = magic && memcmp(magic, cacheMagic, sizeof(cacheMagic)) == 0 && in.u64() == version &&
+                 in.u64() == sourceSize && in.u64() == sourceMtime;
+
+    if (valid) {
+        uint64_t numTechs = in.u64();
+        vector<int> libIds;  // 檢查完 numLibCells 再比對範圍
+        for (uint64_t t = 0; t < numTechs && in.ok; ++t) {
+            vector<LibraryCell> &libs = techLibCells[string(in.str())];
+            uint64_t numLibs = in.u64();
+            for (uint64_t l = 0; l < numLibs && in.ok; ++l) {
+                string name(in.str());
+                uint64_t id = in.u64();
+                double w = in.f64();
+                double h = in.f64();
+                libIds.push_back(id > INT_MAX ? -1 : (int)id);
+                libs.push_back(LibraryCell(name, libIds.back(), w, h));
+            }
+        }
+        uint64_t numDies = in.u64();
+        for (uint64_t d = 0; d < numDies && in.ok; ++d) {
+            string name(in.str());
+            string tech(in.str());
+            double w = in.f64();
+            double h = in.f64();
+            double util = in.f64();
+            dies.push_back(Die(name, tech, w, h, util));
+        }
+        uint64_t libCount = in.u64();
+        valid = in.ok && libCount <= INT_MAX;
+        numLibCells = valid ? libCount : 0;
+        for (size_t l = 0; valid && l < libIds.size(); ++l)
+            valid = libIds[l] >= 0 && libIds[l] < numLibCells;
+
+        uint64_t cellCount = in.u64();
+        uint64_t netCount = in.u64();
+        valid = valid && in.ok && cellCount <= INT_MAX && netCount <= INT_MAX;
+        hg.numCells = valid ? cellCount : 0;
+        hg.numNets = valid ? netCount : 0;
+        size_t numCells = hg.numCells, numNets = hg.numNets;
+        valid = valid && in.copy(hg.cellNetStart, numCells + 1) && in.copy(hg.cellNets, hg.cellNetStart.back()) &&
+                in.copy(hg.netCellStart, numNets + 1) && in.copy(hg.netCells, hg.netCellStart.back()) &&
+                in.copy(hg.netWeight, numNets);
+        size_t numLibIds = 0;
+        const int *libCellId = valid ? in.array<int>(numLibIds) : NULL;
+        valid = valid && in.ok && numLibIds == numCells &&
+                readNames(in, numCells, hg.cellNames) && readNames(in, numNets, hg.netNames);
+        // 兩個方向的 CSR 必須有相同的 pin 數，起點陣列要是合法的前綴和
+        valid = valid && hg.cellNets.size() == hg.netCells.size() &&
+                validStart(hg.cellNetStart, hg.cellNets.size()) && validStart(hg.netCellStart, hg.netCells.size());
+
+        // ID 超出範圍的 cache 不能用 (其他欄位都是 FM 直接拿來當索引的)
+        for (size_t k = 0; valid && k < hg.netCells.size(); ++k)
+            valid = (unsigned)hg.netCells[k] < numCells && (unsigned)hg.cellNets[k] < numNets;
+        for (size_t c = 0; valid && c < numCells; ++c)
+            valid = (unsigned)libCellId[c] < (unsigned)numLibCells;
+        // net 權重不為負，總和放得進 FM 的 gain 範圍 (2 * Pmax + 1 與 cutSize 都是 int)
+        long long totalWeight = 0;
+        for (size_t e = 0; valid && e < numNets; ++e) {
+            totalWeight += hg.netWeight[e];
+            valid = hg.netWeight[e] >= 0 && totalWeight <= INT_MAX / 2;
+        }
+        // cell -> net 必須剛好是 net -> cell 的轉置 (與 parse 時 buildCellNets 的結果相同)
+        if (valid) {
+            vector<int> cachedStart, cachedNets;
+            cachedStart.swap(hg.cellNetStart);
+            cachedNets.swap(hg.cellNets);
+            hg.buildCellNets();
+            valid = cachedStart == hg.cellNetStart && cachedNets == hg.cellNets;
+        }
+        if (valid) {
+            cells.clear();
+            cells.reserve(numCells);
+            for (size_t c = 0; c < numCells; ++c)
+                cells.push_back(Cell(c, hg.cellNames[c], libCellId[c]));
+        }
+    }
+
+    if (!valid) {
+        techLibCells.clear();
+        dies.clear();
+        hg = Hypergraph();
+        cells.clear();
+        munmap(p, size);
+        data = NULL;
+        size = 0;
+        return false;
+    }
+    return true;
+}
+
+bool NetlistCache::save(const string &cacheFile, const string &inFile,
+                        const map<string, vector<LibraryCell>> &techLibCells, const Hypergraph &hg,
+                        const vector<Cell> &cells, const vector<Die> &dies, int numLibCells)
+{
+    uint64_t sourceSize, sourceMtime;
+    if (!sourceStamp(inFile, sourceSize, sourceMtime))
+        return false;
+    string tmpFile = cacheFile + ".tmp." + to_string(getpid());
+    FILE *fp = fopen(tmpFile.c_str(), "wb");
+    if (!fp) {
+        cerr << "[Warning] Cannot write cache file: " << cacheFile << endl;
+        return false;
+    }
+
+    CacheWriter out(fp);
+    out.raw(cacheMagic, sizeof(cacheMagic));
+    out.u64(version);
+    out.u64(sourceSize);
+    out.u64(sourceMtime);
+
+    out.u64(techLibCells.size());
+    for (const auto &kv : techLibCells) {
+        out.str(kv.first);
+        out.u64(kv.second.size());
+        for (const LibraryCell &lib : kv.second) {
+            out.str(lib.name);
+            out.u64(lib.id);
+            out.f64(lib.width);
+            out.f64(lib.height);
+        }
+    }
+    out.u64(dies.size());
+    for (const Die &die : dies) {
+        out.str(die.name);
+        out.str(die.techName);
+        out.f64(die.width);
+        out.f64(die.height);
+        out.f64(die.util);
+    }
+    out.u64(numLibCells);
+
+    out.u64(hg.numCells);
+    out.u64(hg.numNets);
+    out.array(hg.cellNetStart.data(), hg.cellNetStart.size());
+    out.array(hg.cellNets.data(), hg.cellNets.size());
+    out.array(hg.netCellStart.data(), hg.netCellStart.size());
+    out.array(hg.netCells.data(), hg.netCells.size());
+    out.array(hg.netWeight.data(), hg.netWeight.size());
+    vector<int> libCellId(cells.size());
+    for (const Cell &c : cells)
+        libCellId[c.id] = c.libCellId;
+    out.array(libCellId.data(), libCellId.size());
+    writeNames(out, hg.cellNames);
+    writeNames(out, hg.netNames);
+
+    bool ok = out.ok;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmpFile.c_str(), cacheFile.c_str()) != 0) {
+        remove(tmpFile.c_str());
+        cerr << "[Warning] Cannot write cache file: " << cacheFile << endl;
+        return false;
+    }
+    return true;
+}
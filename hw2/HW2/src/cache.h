@@ -0,0 +1,48 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "lib.h"
+#include "hypergraph.h"
+
+using namespace std;
+
+/************************************
+ * NetlistCache:
+ *   把 parse 的結果存成二進位檔 (--cache)，之後同一個輸入檔直接 mmap 進來，不必再解析文字
+ *   檔案內容依序為：
+ *     header (magic、版本、輸入檔的大小與修改時間)
+ *     tech 與 LibCell 表、dies、lib cell 名稱數
+ *     Hypergraph 的 CSR 陣列、每顆 cell 的 lib cell ID
+ *     cell / net 名稱 (offset 陣列 + 所有名稱接在一起的 blob)
+ *   每個陣列前面是 8-byte 的長度，陣列本身對齊 8 byte
+ *   輸入檔的大小或修改時間不同、版本不同或檔案損壞時 load 回傳 false，由呼叫端重新解析並覆寫
+ *   整數陣列複製進 Hypergraph (memcpy)，名稱則是指向 mmap 區域的 string_view，
+ *   所以 NetlistCache 必須比 Hypergraph、cells 活得久 (同 Parser)
+ ************************************/
+class NetlistCache {
+    public:
+        static const uint32_t version = 1;
+
+        NetlistCache();
+        ~NetlistCache();
+        NetlistCache(const NetlistCache &) = delete;
+        NetlistCache &operator=(const NetlistCache &) = delete;
+
+        // inFile 是 cache 對應的輸入檔 (只用來比對大小與修改時間)
+        bool load(const string &cacheFile, const string &inFile, map<string, vector<LibraryCell>> &techLibCells,
+                  Hypergraph &hg, vector<Cell> &cells, vector<Die> &dies, int &numLibCells);
+        // 先寫到暫存檔再 rename，其他同時在跑的 hw2 不會讀到寫一半的 cache；失敗只印警告
+        static bool save(const string &cacheFile, const string &inFile,
+                         const map<string, vector<LibraryCell>> &techLibCells, const Hypergraph &hg,
+                         const vector<Cell> &cells, const vector<Die> &dies, int numLibCells);
+
+    private:
+        const char *data;
+        size_t size;
+};
+
+#endif // CACHE_H
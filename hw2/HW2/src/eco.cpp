@@ -0,0 +1,177 @@
+#include <bits/stdc++.h>
+#include "eco.h"
+using namespace std;
+
+Eco::Eco(const Hypergraph &hg)
+    : numAdded(0), numRemoved(0), numUnknown(0), numFree(0), hg(hg)
+{
+    partition.assign(hg.numCells, 0);
+}
+
+int Eco::findCell(string_view name) const
+{
+    auto it = lower_bound(hg.cellNames.begin(), hg.cellNames.end(), name);
+    if (it == hg.cellNames.end() || *it != name)
+        return -1;
+    return it - hg.cellNames.begin();
+}
+
+
+
+/******************************************************
+  舊輸出檔格式與 writeOutput 相同：
+    CutSize <cut>
+    <dieName> <cell 數>
+    <cell 名稱> ...
+******************************************************/
+bool Eco::readPartition(const string &filename, const vector<Die> &dies, const vector<double> &areaA,
+                        const vector<double> &areaB, double maxAreaA, double maxAreaB)
+{
+    ifstream fin(filename);
+    if (!fin) {
+        cerr << "Cannot open warm-start file: " << filename << endl;
+        return false;
+    }
+    string token;
+    long long cut;
+    if (!(fin >> token >> cut) || token != "CutSize") {
+        cerr << "Bad warm-start file (expected CutSize): " << filename << endl;
+        return false;
+    }
+
+    vector<char> known(hg.numCells, 0);
+    string dieName;
+    long long count;
+    while (fin >> dieName >> count) {
+        int side = dieName == dies[0].name ? 0 : dieName == dies[1].name ? 1 : -1;
+        if (side == -1) {
+            cerr << "Unknown die in warm-start file: " << dieName << endl;
+            return false;
+        }
+        for (long long k = 0; k < count; ++k) {
+            if (!(fin >> token)) {
+                cerr << "Warm-start file ends before all cells of " << dieName << " are listed" << endl;
+                return false;
+            }
+            int c = findCell(token);
+            if (c == -1) {
+                ++numRemoved;
+                continue;
+            }
+            partition[c] = side;
+            known[c] = 1;
+        }
+    }
+
+    double usedAreaA = 0.0, usedAreaB = 0.0;
+    for (int c = 0; c < hg.numCells; ++c) {
+        if (!known[c])
+            continue;
+        if (partition[c])
+            usedAreaB += areaB[c];
+        else
+            usedAreaA += areaA[c];
+    }
+    // 新增的 cell：只有一邊放得下就放那邊，否則放到剩餘空間較多的那邊
+    for (int c = 0; c < hg.numCells; ++c) {
+        if (known[c])
+            continue;
+        ++numAdded;
+        seedCells.push_back(c);
+        bool fitA = usedAreaA + areaA[c] <= maxAreaA;
+        bool fitB = usedAreaB + areaB[c] <= maxAreaB;
+        bool side = fitA != fitB ? fitB : (maxAreaA - usedAreaA - areaA[c]) < (maxAreaB - usedAreaB - areaB[c]);
+        partition[c] = side;
+        if (side)
+            usedAreaB += areaB[c];
+        else
+            usedAreaA += areaA[c];
+    }
+    return true;
+}
+
+bool Eco::readDelta(const string &filename)
+{
+    ifstream fin(filename);
+    if (!fin) {
+        cerr << "Cannot open ECO file: " << filename << endl;
+        return false;
+    }
+    vector<string> netNames;
+    string line, kind, name;
+    while (getline(fin, line)) {
+        istringstream ss(line);
+        if (!(ss >> kind) || kind[0] == '#')
+            continue;
+        if (!(ss >> name) || (kind != "Cell" && kind != "Net")) {
+            cerr << "Bad line in ECO file: " << line << endl;
+            return false;
+        }
+        if (kind == "Net") {
+            netNames.push_back(name);
+            continue;
+        }
+        int c = findCell(name);
+        if (c == -1)
+            ++numUnknown;
+        else
+            seedCells.push_back(c);
+    }
+
+    // net 不依名稱排序，掃一次所有 net 名稱 (變更檔通常很小)
+    if (!netNames.empty()) {
+        unordered_set<string_view> wanted(netNames.begin(), netNames.end());
+        size_t found = 0;
+        for (int e = 0; e < hg.numNets; ++e) {
+            if (wanted.count(hg.netNames[e])) {
+                seedNets.push_back(e);
+                ++found;
+            }
+        }
+        numUnknown += wanted.size() - found;
+    }
+    return true;
+}
+
+
+
+/******************************************************
+  BFS：種子 cell 與變更的 net 上的 cell 是第 0 層，
+  之後每層沿著還沒走過、degree <= maxExpandDegree 的 net 放開相鄰的 cell
+******************************************************/
+vector<char> Eco::fixedCells(int radius)
+{
+    vector<char> fixed(hg.numCells, 1);
+    vector<char> netSeen(hg.numNets, 0);
+    vector<int> frontier, next;
+    numFree = 0;
+    auto release = [&](int c) {
+        if (fixed[c]) {
+            fixed[c] = 0;
+            ++numFree;
+            next.push_back(c);
+        }
+    };
+
+    for (int c : seedCells)
+        release(c);
+    for (int e : seedNets) {
+        netSeen[e] = 1;
+        for (const int *v = hg.netCellBegin(e); v != hg.netCellEnd(e); ++v)
+            release(*v);
+    }
+    for (int r = 0; r < radius && !next.empty(); ++r) {
+        frontier.swap(next);
+        next.clear();
+        for (int c : frontier) {
+            for (const int *e = hg.cellNetBegin(c); e != hg.cellNetEnd(c); ++e) {
+                if (netSeen[*e] || hg.netDegree(*e) > maxExpandDegree)
+                    continue;
+                netSeen[*e] = 1;
+                for (const int *v = hg.netCellBegin(*e); v != hg.netCellEnd(*e); ++v)
+                    release(*v);
+            }
+        }
+    }
+    return fixed;
+}
@@ -0,0 +1,56 @@
+#ifndef ECO_H
+#define ECO_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "lib.h"
+#include "hypergraph.h"
+
+using namespace std;
+
+/************************************
+ * Eco:
+ *   小幅修改 (ECO) 之後的增量重新分割
+ *   readPartition: 讀入上一次的輸出檔當初始解 (warm start)
+ *     新的 netlist 有、舊輸出沒有的 cell 是新增的 cell，依序放到放得下 (剩餘空間較多) 的那邊
+ *     舊輸出有、新的 netlist 沒有的 cell 已經刪除，直接略過
+ *   readDelta: ECO 變更檔，一行一筆，# 開頭為註解
+ *       Cell <name>   新增或修改過的 cell (例如換了 LibCell)
+ *       Net <name>    新增或修改過的 net
+ *     刪除的 net 已經不在新的 netlist 裏，要把它原本連到、仍存在的 cell 列成 Cell
+ *   fixedCells: 以變更的 cell、變更的 net 上的 cell 以及新增的 cell 為種子，
+ *     沿著 net 擴張 radius 層，範圍內的 cell 可以移動，其餘固定在原本的 die (見 FM::setFixed)
+ *     走訪的只有範圍內的 cell 與 net，所以 FM 的工作量跟著變更的大小走
+ ************************************/
+class Eco {
+    public:
+        // degree 超過這個值的 net 不往外擴張 (否則一條 clock / reset net 就會放開大半個設計)
+        static const int maxExpandDegree = 64;
+
+        vector<char> partition;  // warm start 的分割 (0 => DieA, 1 => DieB)
+        int numAdded;            // 新增的 cell 數
+        int numRemoved;          // 舊輸出中已經不存在的 cell 數
+        int numUnknown;          // 變更檔中在新的 netlist 找不到的名稱數
+        int numFree;             // fixedCells 放開的 cell 數
+
+    public:
+        explicit Eco(const Hypergraph &hg);
+
+        // 舊輸出的 die 名稱要與 dies[0] / dies[1] 相同；檔案壞掉時印出錯誤並回傳 false
+        bool readPartition(const string &filename, const vector<Die> &dies, const vector<double> &areaA,
+                           const vector<double> &areaB, double maxAreaA, double maxAreaB);
+        bool readDelta(const string &filename);
+        // fixed[c] = 1 表示 cell c 固定
+        vector<char> fixedCells(int radius);
+
+    private:
+        const Hypergraph &hg;
+        vector<int> seedCells;
+        vector<int> seedNets;
+
+        // cell ID 依名稱排序指定，所以可以二分搜尋；找不到回傳 -1
+        int findCell(string_view name) const;
+};
+
+#endif // ECO_H
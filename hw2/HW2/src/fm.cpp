@@ -0,0 +1,568 @@
+#include <bits/stdc++.h>
+#include "fm.h"
+#include "verify.h"
+using namespace std;
+
+FM::FM(const Hypergraph &hg, const vector<double> &areaA, const vector<double> &areaB,
+       double maxAreaA, double maxAreaB)
+    : hg(hg), areaA(areaA), areaB(areaB),
+      maxAreaA(maxAreaA), maxAreaB(maxAreaB),
+      cutSize(0), Pmax(0), initCutSize(0), bestPass(0), earlyExit(0), largeNetDegree(0), budget(NULL), numThreads(1), ready(false)
+{
+    // Pmax: 所有 cell 中，連接 net 權重和的最大值
+    for (int c = 0; c < hg.numCells; ++c) {
+        int sumWeight = 0;
+        for (const int *e = hg.cellNetBegin(c); e != hg.cellNetEnd(c); ++e)
+            sumWeight += hg.netWeight[*e];
+        if (sumWeight > Pmax)
+            Pmax = sumWeight;
+    }
+
+    partition.assign(hg.numCells, 0);
+    gain.assign(hg.numCells, 0);
+    lock.assign(hg.numCells, 0);
+    cellDirty.assign(hg.numCells, 0);
+    nets.resize(hg.numNets);
+    netGain.assign((size_t)hg.numNets * 2, 0);
+    // DieA 那一邊的 cell 搬過去後佔 areaB，反之亦然
+    buckets.push_back(Bucket("A", Pmax, areaB));
+    buckets.push_back(Bucket("B", Pmax, areaA));
+}
+
+
+
+/******************************************************
+  初始化解（與先前類似，但要檢查面積限制）
+  這裡示範：先都放在 DieA，然後依序搬到 DieB，
+  直到不超過 DieB 利用率限制即可。
+******************************************************/
+void FM::initSolution()
+{
+    // 全部先放在 DieA
+    double usedAreaA = 0.0;
+    double usedAreaB = 0.0;
+    for (int c = 0; c < hg.numCells; ++c) {
+        partition[c] = 0; // 0 => DieA
+        usedAreaA += areaA[c];
+    }
+
+    // 如果 DieA 的面積超標，搬移部分 cell 到 DieB
+    if (usedAreaA > maxAreaA) {
+        // 將 cell 按 (areaA - areaB) 從大到小排序
+        vector<int> allCells(hg.numCells);
+        for (int c = 0; c < hg.numCells; ++c)
+            allCells[c] = c;
+        sort(allCells.begin(), allCells.end(),
+             [this](int a, int b){ return (areaA[a] - areaB[a]) > (areaA[b] - areaB[b]); });
+
+        // 遍歷這些 cell，嘗試搬移直到 DieA 的面積滿足限制
+        for (int c : allCells) {
+            if (usedAreaA <= maxAreaA)
+                break;
+            // 檢查如果把此 cell 搬到 DieB，
+            // DieB 的面積不會超過限制，同時減少 DieA 的面積
+            if ((usedAreaB + areaB[c]) <= maxAreaB) {
+                // 搬移 cell：從 DieA 到 DieB
+                partition[c] = 1;
+                usedAreaA -= areaA[c];
+                usedAreaB += areaB[c];
+            }
+        }
+    }
+    cutSize = recalcCutSize();
+    ready = false;
+}
+
+void FM::randomSolution(mt19937 &rng)
+{
+    vector<int> order(hg.numCells);
+    for (int c = 0; c < hg.numCells; ++c)
+        order[c] = c;
+    shuffle(order.begin(), order.end(), rng);
+
+    double usedAreaA = 0.0;
+    double usedAreaB = 0.0;
+    for (int c : order) {
+        bool fitA = usedAreaA + areaA[c] <= maxAreaA;
+        bool fitB = usedAreaB + areaB[c] <= maxAreaB;
+        bool side = rng() & 1;
+        if (fitA != fitB)
+            side = fitB;
+        else if (!fitA)  // 兩邊都放不下，放到剩餘空間較多的那邊
+            side = (maxAreaA - usedAreaA - areaA[c]) < (maxAreaB - usedAreaB - areaB[c]);
+        partition[c] = side;
+        if (side)
+            usedAreaB += areaB[c];
+        else
+            usedAreaA += areaA[c];
+    }
+    cutSize = recalcCutSize();
+    ready = false;
+}
+
+void FM::setPartition(const vector<char> &part)
+{
+    partition = part;
+    cutSize = recalcCutSize();
+    ready = false;
+}
+
+void FM::setFixed(const vector<char> &fixedCells)
+{
+    fixed = fixedCells;
+    ready = false;
+}
+
+
+
+/******************************************************
+  整個重建 gain 之前：依 partition 重算兩邊的 cell 數與面積，
+  並清掉 lock 以及 gain bucket (net 計數與 gain 由 initGainAndBuckets 直接寫入)
+  固定的 cell 一開始就 lock，之後的 gain 更新都會略過它們
+******************************************************/
+void FM::resetBuckets()
+{
+    for (int s = 0; s < 2; ++s) {
+        buckets[s].cnt = 0;
+        buckets[s].size = 0;
+        // 上一回合沒被選到的 cell 還留在 gain bucket 裏，整個清掉重建
+        buckets[s].clearList();
+    }
+    for (int c = 0; c < hg.numCells; ++c) {
+        ++buckets[partition[c]].cnt;
+        buckets[partition[c]].size += partition[c] ? areaB[c] : areaA[c];
+        lock[c] = isFixed(c);
+    }
+}
+
+// 把 [0, n) 依 start (CSR 的起點，size n + 1) 切成 pin 數差不多的 numThreads 段，
+// 每段呼叫 f(begin, end, t)；numThreads == 1 時直接在目前的 thread 做
+template<class F>
+static void forEachChunk(int numThreads, int n, const vector<int> &start, F f)
+{
+    if (numThreads <= 1) {
+        f(0, n, 0);
+        return;
+    }
+    vector<int> bound(numThreads + 1, n);
+    bound[0] = 0;
+    for (int t = 1; t < numThreads; ++t) {
+        long long pins = (long long)start[n] * t / numThreads;
+        bound[t] = lower_bound(start.begin(), start.begin() + n, (int)pins) - start.begin();
+    }
+    vector<thread> threads;
+    for (int t = 1; t < numThreads; ++t)
+        threads.emplace_back(f, bound[t], bound[t + 1], t);
+    f(bound[0], bound[1], 0);
+    for (auto &th : threads)
+        th.join();
+}
+
+
+
+/******************************************************
+  整個重建 net 計數、gain 與 bucket，分成三個資料平行的步驟：
+  1. 逐條 net (可分給多個 thread)：用不分支的迴圈算出兩邊的 pin 數與 ID XOR，
+     並把 net 分類成「對兩邊的 cell 各貢獻多少 gain」存進 netGain
+       某邊只有一顆 (另一邊有 pin)：那一邊的 cell +weight (就是 critical cell)
+       整條 net 在同一邊 (pin 數 > 1，非大 net)：那一邊的 cell -weight
+  2. 逐顆 cell (可分給多個 thread)：依 cellNets 把所在那一邊的 netGain 加起來，
+     只依 cell 順序寫入 gain，沒有隨機寫入，thread 之間也不用合併部分結果
+  3. 依 cell ID 順序放進 bucket (與逐條 net 累加 gain 的結果、順序都相同)
+  固定的 cell (resetBuckets 已經 lock) 不算 gain 也不放進 bucket
+******************************************************/
+void FM::initGainAndBuckets()
+{
+    PROFILE_SCOPE(PhaseInitGain);
+    int threads = (int)min<long long>(max(1, numThreads), (long long)hg.netCells.size() / minPinsPerThread);
+    threads = max(1, threads);
+
+    vector<int> partialCut(threads, 0);
+    forEachChunk(threads, hg.numNets, hg.netCellStart, [&](int begin, int end, int t) {
+        const char *part = partition.data();
+        int cut = 0;
+        for (int e = begin; e < end; ++e) {
+            int ones = 0, x = 0, xB = 0;
+            for (const int *c = hg.netCellBegin(e); c != hg.netCellEnd(e); ++c) {
+                int side = part[*c] & 1;
+                ones += side;
+                x ^= *c;
+                xB ^= *c & -side;
+            }
+            Net &n = nets[e];
+            int degree = hg.netDegree(e);
+            n.cntBucket[0] = degree - ones;
+            n.cntBucket[1] = ones;
+            n.idXor[0] = x ^ xB;
+            n.idXor[1] = xB;
+            n.lock[0] = n.lock[1] = 0;
+
+            int weight = hg.netWeight[e];
+            bool isCut = ones != 0 && ones != degree;
+            int uncutLoss = degree > 1 && !isLargeNet(e) ? -weight : 0;
+            cut += isCut ? weight : 0;
+            netGain[2 * e] = isCut ? (degree - ones == 1 ? weight : 0) : (ones == 0 ? uncutLoss : 0);
+            netGain[2 * e + 1] = isCut ? (ones == 1 ? weight : 0) : (ones == degree ? uncutLoss : 0);
+        }
+        partialCut[t] = cut;
+    });
+    cutSize = accumulate(partialCut.begin(), partialCut.end(), 0);
+
+    forEachChunk(threads, hg.numCells, hg.cellNetStart, [&](int begin, int end, int) {
+        for (int c = begin; c < end; ++c) {
+            if (lock[c])
+                continue;
+            const int *g = netGain.data() + (partition[c] & 1);
+            int sum = 0;
+            for (const int *e = hg.cellNetBegin(c); e != hg.cellNetEnd(c); ++e)
+                sum += g[2 * *e];
+            gain[c] = sum;
+        }
+    });
+
+    for (int c = 0; c < hg.numCells; ++c)
+        if (!lock[c])
+            buckets[partition[c]].insert(c, gain[c] + Pmax);
+}
+
+
+
+/******************************************************
+  在 side 這一邊 gain index i 的 gain 串列中，找第一顆「搬到另一邊後兩邊面積都不超過限制」的 cell
+  (與逐一走訪 gain 串列的結果相同)，找不到回傳 -1 (不會把 cell 從 bucket 移除)
+******************************************************/
+int FM::findFeasible(bool side, int i)
+{
+    Bucket &from = buckets[side];
+    const Bucket &to = buckets[!side];
+    const vector<double> &fromArea = side ? areaB : areaA;
+    const vector<double> &toArea = side ? areaA : areaB;
+    double maxFrom = side ? maxAreaB : maxAreaA;
+    double maxTo = side ? maxAreaA : maxAreaB;
+    if (from.listHead[i] == -1)
+        return -1;
+
+    if (from.size > maxFrom) {
+        // 這一邊本來就超過限制 (例如還沒修正的初始解)，搬出去的 cell 也要夠大，只能逐一檢查
+        for (int c = from.listHead[i]; c != -1; c = from.node[c].next)
+            if (from.size - fromArea[c] <= maxFrom && to.size + toArea[c] <= maxTo)
+                return c;
+        return -1;
+    }
+
+    // 這一邊沒超過限制時，搬出任何 cell 都不會讓它超過，只剩另一邊放不放得下
+    return from.firstFit(i, [&](double a){ return to.size + a <= maxTo; });
+}
+
+int FM::cellSelect()
+{
+    PROFILE_COUNT(selects, 1);
+    int indexA = buckets[0].maxIndex;
+    int indexB = buckets[1].maxIndex;
+    bool tie = false;
+
+    // 當至少有一邊還有候選的 bucket 時
+    while (indexA >= 0 || indexB >= 0) {
+        tie = false;
+        // 若兩邊最高 gain 的 bucket 索引相同，則以目前總面積較大的 partition 為優先
+        if (indexA == indexB && buckets[0].size >= buckets[1].size)
+            tie = true;
+
+        if (indexA > indexB || tie) {
+            // 從 A partition (buckets[0]) 選取候選 Cell
+            int c = findFeasible(0, indexA);
+            if (c != -1) {
+                buckets[0].remove(c, indexA);
+                return c;
+            }
+            PROFILE_COUNT(infeasibleSkips, buckets[0].listHead[indexA] != -1);
+            --indexA; // 當前 bucket 中沒有合適的候選，降低 gain 索引再試
+        }
+        else {
+            // 從 B partition (buckets[1]) 選取候選 Cell
+            int c = findFeasible(1, indexB);
+            if (c != -1) {
+                buckets[1].remove(c, indexB);
+                return c;
+            }
+            PROFILE_COUNT(infeasibleSkips, buckets[1].listHead[indexB] != -1);
+            --indexB;
+        }
+    }
+    return -1; // 若無任何 Cell 符合條件則回傳 -1
+}
+
+
+
+void FM::updatePartition(int target, bool from)
+{
+    partition[target] = !from;
+    lock[target] = 1;
+    --buckets[from].cnt;
+    ++buckets[!from].cnt;
+
+    if(!from){ // from 是 A
+        buckets[from].size -= areaA[target];
+        buckets[!from].size += areaB[target];
+    }else{ // from 是 B
+        buckets[from].size -= areaB[target];
+        buckets[!from].size += areaA[target];
+    }
+}
+
+
+
+void FM::updateBucketList(int c, int change)
+{
+    int i = gain[c] + Pmax;
+    buckets[partition[c]].remove(c, i);
+    buckets[partition[c]].insert(c, i + change);
+}
+
+// 把 cell c 在 net netId 上的 pin 從 from 邊移到另一邊 (cell 數與 ID XOR)
+inline void FM::shiftPin(int netId, int c, bool from)
+{
+    Net &net = nets[netId];
+    --net.cntBucket[from];
+    ++net.cntBucket[!from];
+    net.idXor[from] ^= c;
+    net.idXor[!from] ^= c;
+}
+
+
+
+/******************************************************
+  target 由 from 搬到另一邊時，更新 net netId 上其他 cell 的 gain 以及 cutSize
+  cutSize 依 net 計數的變化更新，不依賴 gain (大 net 的 gain 不精確)
+******************************************************/
+void FM::updateGain(int target, int netId, bool from)
+{
+    Net &net = nets[netId];
+    int weight = hg.netWeight[netId];
+    // 大 net 不維護「整條 net 在同一邊」那一項，跳過 O(fanout) 的更新
+    bool large = isLargeNet(netId);
+    PROFILE_NET(hg.netDegree(netId));
+    // check critical nets before the move
+    if (net.cntBucket[!from] == 0) {
+        // 原本整條 net 都在 from 邊，搬走一顆 (且不是最後一顆) 就被切
+        if (net.cntBucket[from] > 1)
+            cutSize += weight;
+        if (!large) {
+            for (const int *c = hg.netCellBegin(netId); c != hg.netCellEnd(netId); ++c) {
+                if (!lock[*c]) {
+                    updateBucketList(*c, weight);
+                    gain[*c] += weight;
+                    PROFILE_GAIN(hg.netDegree(netId), 1);
+                }
+            }
+        }
+    }
+    else if (net.cntBucket[!from] == 1) {
+        // 另一邊唯一的 cell 就是 ID XOR (target 在 from 邊)
+        int critical = net.idXor[!from];
+        if (!lock[critical]) {
+            updateBucketList(critical, -weight);
+            gain[critical] -= weight;
+            PROFILE_GAIN(hg.netDegree(netId), 1);
+        }
+    }
+    shiftPin(netId, target, from);
+    // check critical nets after the move
+    if (net.cntBucket[from] == 0) {
+        // 原本被切 (另一邊本來就有 cell)，現在整條 net 都在另一邊
+        if (net.cntBucket[!from] > 1)
+            cutSize -= weight;
+        if (!large) {
+            for (const int *c = hg.netCellBegin(netId); c != hg.netCellEnd(netId); ++c) {
+                if (!lock[*c]) {
+                    updateBucketList(*c, -weight);
+                    gain[*c] -= weight;
+                    PROFILE_GAIN(hg.netDegree(netId), 1);
+                }
+            }
+        }
+    }
+    else if (net.cntBucket[from] == 1) {
+        int critical = net.idXor[from];
+        if (!lock[critical]) {
+            updateBucketList(critical, weight);
+            gain[critical] += weight;
+            PROFILE_GAIN(hg.netDegree(netId), 1);
+        }
+    }
+}
+
+
+
+/**
+ * 依 move log 由後往前把 bestPass 之後的移動撤銷：
+ * partition、兩邊的面積/cell 數、每條 net 的 cntBucket / idXor 都逐步改回去，
+ * 不需要重新掃整個 netlist。
+ **/
+void FM::rollback()
+{
+    PROFILE_SCOPE(PhaseRecalcAfterBestPass);
+    for (int i = (int)move.size() - 1; i >= bestPass; --i) {
+        int c = move[i].first;
+        bool from = move[i].second;
+        partition[c] = from;
+        ++buckets[from].cnt;
+        --buckets[!from].cnt;
+        buckets[from].size += from ? areaB[c] : areaA[c];
+        buckets[!from].size -= from ? areaA[c] : areaB[c];
+        for (const int *e = hg.cellNetBegin(c); e != hg.cellNetEnd(c); ++e)
+            shiftPin(*e, c, !from);
+    }
+}
+
+// 依目前的 net 計數算出 cell c 的 gain (與 initGainAndBuckets 的規則相同)
+int FM::computeGain(int c)
+{
+    bool side = partition[c];
+    int g = 0;
+    for (const int *e = hg.cellNetBegin(c); e != hg.cellNetEnd(c); ++e) {
+        const Net &n = nets[*e];
+        if (n.cntBucket[side] == 1 && n.cntBucket[!side] > 0)
+            g += hg.netWeight[*e];
+        else if (n.cntBucket[!side] == 0 && n.cntBucket[side] > 1 && !isLargeNet(*e))
+            g -= hg.netWeight[*e];
+    }
+    return g;
+}
+
+/**
+ * rollback 之後準備下一個 pass：
+ * 只有「這個 pass 移動過的 cell 所連的 net」上的 cell，gain 才可能和 pass 開始時不同，
+ * 把這些 cell 的 gain 重算並放回正確的 bucket，net / cell 的 lock 也只清這些。
+ * 沒被碰到的 cell 一直留在 bucket 裏，gain 也仍然正確。
+ **/
+void FM::prepareNextPass()
+{
+    PROFILE_SCOPE(PhaseRecalcAfterBestPass);
+    vector<int> dirty;
+    for (size_t i = 0; i < move.size(); ++i) {
+        int c = move[i].first;
+        if (!cellDirty[c]) {
+            cellDirty[c] = 1;
+            dirty.push_back(c);
+        }
+        for (const int *e = hg.cellNetBegin(c); e != hg.cellNetEnd(c); ++e) {
+            if (!nets[*e].lock[0] && !nets[*e].lock[1])
+                continue;  // 已經處理過這條 net
+            nets[*e].lock[0] = nets[*e].lock[1] = 0;
+            for (const int *v = hg.netCellBegin(*e); v != hg.netCellEnd(*e); ++v) {
+                if (!cellDirty[*v]) {
+                    cellDirty[*v] = 1;
+                    dirty.push_back(*v);
+                }
+            }
+        }
+    }
+
+    for (int c : dirty) {
+        cellDirty[c] = 0;
+        if (isFixed(c))
+            continue;
+        int g = computeGain(c);
+        if (lock[c]) {
+            // 被選過的 cell 已經不在 bucket 裏
+            lock[c] = 0;
+            gain[c] = g;
+            buckets[partition[c]].insert(c, g + Pmax);
+        }
+        else if (g != gain[c]) {
+            updateBucketList(c, g - gain[c]);
+            gain[c] = g;
+        }
+    }
+}
+
+
+
+int FM::runPass()
+{
+    // 時間已經用完：不動目前的解
+    if (budget && budget->expired())
+        return 0;
+    if (!ready) {
+        // 新的 partition：整個重建一次，之後的 pass 都是增量更新
+        resetBuckets();
+        initGainAndBuckets();
+        ready = true;
+    }
+    initCutSize = cutSize;
+
+    int pass = 0;
+    int minCutSize = cutSize;
+    bestPass = 0;
+    move.clear();
+
+    PROFILE_START(selectMove);
+    int target = cellSelect();
+    while (target != -1) {
+        ++pass;
+        PROFILE_COUNT(moves, 1);
+        bool from = partition[target];
+        move.push_back(make_pair(target, from));
+        updatePartition(target, from);
+        // cutSize 在 updateGain 中依 net 計數更新 (兩邊都有 lock 的 net 一定被切，cut 不變)
+        for (const int *e = hg.cellNetBegin(target); e != hg.cellNetEnd(target); ++e) {
+            int i = *e;
+            if (!(nets[i].lock[0] && nets[i].lock[1]))
+                updateGain(target, i, from);
+            else
+                shiftPin(i, target, from);
+            nets[i].lock[!from] = 1;
+        }
+        if (minCutSize > cutSize) {
+            minCutSize = cutSize;
+            bestPass = pass;
+        }
+        // early exit: 連續 earlyExit 步都沒有比 bestPass 更好，後面的移動幾乎都會被撤銷
+        if (earlyExit > 0 && pass - bestPass >= earlyExit)
+            break;
+        // 時間用完就停在這裡，之後一樣 rollback 到 bestPass
+        if (budget && pass % budgetCheckInterval == 0 && budget->expired())
+            break;
+        target = cellSelect();
+    }
+    PROFILE_STOP(selectMove, PhaseSelectMove);
+
+    rollback();
+    cutSize = minCutSize;
+    prepareNextPass();
+    // debug build：增量維護的 cut 必須與重新計算的相同
+    assert(cutSize == computeCutSize(hg, partition));
+    // 回傳這個 pass 實際減少的 cut (大 net 的 gain 不精確，所以不用 partial sum)
+    return initCutSize - cutSize;
+}
+
+void FM::refine(int maxPasses)
+{
+    for (int p = 0; p < maxPasses; ++p)
+        if (runPass() <= 0)
+            break;
+}
+
+
+
+/**
+ * 依照目前 partition 重新計算 cutSize (見 verify.h，不需要 net 計數)
+ * net 計數在下一個 pass 開始時 (resetBuckets / initGainAndBuckets) 才重建
+ **/
+int FM::recalcCutSize()
+{
+    return computeCutSize(hg, partition);
+}
+
+bool FM::isFeasible() const
+{
+    double sizeA = 0, sizeB = 0;
+    for (int c = 0; c < hg.numCells; ++c) {
+        if (partition[c])
+            sizeB += areaB[c];
+        else
+            sizeA += areaA[c];
+    }
+    return sizeA <= maxAreaA && sizeB <= maxAreaB;
+}
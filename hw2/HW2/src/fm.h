@@ -0,0 +1,106 @@
+#ifndef FM_H
+#define FM_H
+
+#include <vector>
+#include <random>
+#include "lib.h"
+#include "hypergraph.h"
+#include "budget.h"
+
+using namespace std;
+
+/************************************
+ * FM:
+ *   two-way FM 引擎，只看 Hypergraph 與每顆 cell 在 DieA/DieB 的面積，
+ *   不依賴 cell 名稱，所以原始 netlist 與 multilevel 的粗化 netlist 都能用
+ *   partition[c]: 0 => DieA, 1 => DieB
+ ************************************/
+class FM {
+    public:
+        const Hypergraph &hg;
+        const vector<double> &areaA;
+        const vector<double> &areaB;
+        double maxAreaA, maxAreaB;
+
+        vector<char> partition;
+        int cutSize;       // 目前 partition 的 cut size
+        int Pmax;
+
+        // 上一個 pass 的統計 (給 main 印出來用)
+        int initCutSize;
+        int bestPass;
+
+        vector<Bucket> buckets;  // 一邊一個 bucket
+
+        // 一個 pass 中連續這麼多步都沒有改善 bestPass 就提早結束 (0 => 不提早結束)
+        int earlyExit;
+
+        // degree 超過這個值的 net 視為大 net (0 => 沒有大 net)：
+        // gain 只算「某邊只剩一顆 cell」那一項，不算「整條 net 在同一邊」的 -weight，
+        // 所以 net 由不被切變成被切 (或反過來) 時不用走訪整條 net 更新 gain
+        // cutSize 仍由 net 計數精確維護，只有 cell 的挑選順序是近似的
+        int largeNetDegree;
+
+        // 時間預算 (NULL => 不限時)：用完時 pass 會在中途停下，照常退回 bestPass 的分割
+        const TimeBudget *budget;
+        // 每隔幾步檢查一次時間
+        static const int budgetCheckInterval = 256;
+
+        // 整個重建 gain (initGainAndBuckets) 時用幾個 thread (1 => 不開 thread)
+        // multistart 的每個 FM 已經各佔一個 thread，維持 1
+        int numThreads;
+        // 每個 thread 至少分到這麼多個 pin 才開 thread (小的 netlist / 粗化層開 thread 不划算)
+        static const int minPinsPerThread = 1 << 16;
+
+    public:
+        FM(const Hypergraph &hg, const vector<double> &areaA, const vector<double> &areaB,
+           double maxAreaA, double maxAreaB);
+
+        // 初始化解：先都放在 DieA，再依 (areaA - areaB) 由大到小搬到 DieB
+        void initSolution();
+        // 隨機初始化解：依亂數順序逐一放到隨機的一邊，放不下就放另一邊
+        void randomSolution(mt19937 &rng);
+        // 直接指定 partition (例如 multilevel 由粗化層投影下來的解)
+        void setPartition(const vector<char> &part);
+        // 固定的 cell (fixed[c] = 1) 一直留在目前的 die，不放進 bucket 也不會被選到，
+        // 但仍算在面積與 cut 裏；空的 vector 表示沒有固定的 cell
+        void setFixed(const vector<char> &fixedCells);
+
+        // 做一個 FM pass，結束後 partition 回到 bestPass 的分割，cutSize 為對應的 cut
+        // 第一個 pass 會整個建立 gain / bucket，之後只依 move log 增量更新
+        // 回傳這個 pass 減少的 cut (> 0 代表這個 pass 有改善)
+        int runPass();
+        // 一直做 pass 直到沒有改善或達到 maxPasses
+        void refine(int maxPasses);
+
+        // 依目前 partition 重新計算 cut (只在換新的 partition 時用，pass 之間 cut 是增量維護的)
+        int recalcCutSize();
+        // 目前 partition 兩邊的面積是否都沒超過限制
+        bool isFeasible() const;
+
+    private:
+        vector<int> gain;
+        vector<char> lock;
+        vector<char> fixed;  // 空的 => 沒有固定的 cell
+        vector<Net> nets;
+        vector<int> netGain;  // netGain[e * 2 + s]: net e 對 side s 上的 cell 貢獻的 gain (只在 initGainAndBuckets 用)
+        vector<pair<int, bool> > move;  // move log: (cell ID, from)
+        vector<char> cellDirty;
+        bool ready;  // gain / bucket / net 計數是否對應目前的 partition
+
+        void resetBuckets();
+        void initGainAndBuckets();
+        int findFeasible(bool side, int i);
+        int cellSelect();
+        void updatePartition(int target, bool from);
+        void updateBucketList(int c, int change);
+        void shiftPin(int netId, int c, bool from);
+        bool isLargeNet(int e) const { return largeNetDegree > 0 && hg.netDegree(e) > largeNetDegree; }
+        bool isFixed(int c) const { return !fixed.empty() && fixed[c]; }
+        void updateGain(int target, int netId, bool from);
+        void rollback();
+        int computeGain(int c);
+        void prepareNextPass();
+};
+
+#endif // FM_H
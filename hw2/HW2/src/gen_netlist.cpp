@@ -0,0 +1,278 @@
+#include <bits/stdc++.h>
+using namespace std;
+
+/******************************************************
+  合成 netlist 產生器 (hw2 輸入格式)
+  用法: ./gen_netlist <out.txt> [options]
+    --cells N          cell 數 (預設 10000，至少 2，最多 10M 也可以，檔案邊產生邊寫出)
+    --nets M           net 數 (預設與 cell 數相同)
+    --degree SPEC      net degree 分佈：
+                         fixed:k         每條 net 都是 k 個 pin
+                         uniform:a:b     [a, b] 均勻分佈
+                         powerlaw:alpha  P(d) ~ d^-alpha，d >= 2 (預設 powerlaw:2.5，接近 public 測資)
+    --max-degree D     degree 上限 (預設 1000)
+    --weight W         net weight 在 [1, W] 均勻分佈 (預設 1)
+    --libcells L       每個 tech 的 LibCell 數 (預設 32)
+    --lib-skew s       lib cell 的使用頻率 ~ rank^-s，0 為均勻 (預設 1)
+    --util-a U         DieA 的 utilization (預設 80)
+    --util-b U         DieB 的 utilization (預設 90)
+    --fill F           cell 面積佔 (兩邊可用面積) 的比例，越接近 1 面積限制越緊 (預設 0.9)
+    --dies K           K > 2 時輸出 "NumDies K" + "Die D<i> <tech> <util>" (tech 輪流用 TA/TB)
+    --locality W       net 的 pin 大多落在 W 顆 cell 的範圍內 (預設 64)，讓 netlist 有可切的結構
+    --seed S           亂數種子 (預設 1)
+  cell 名稱 C1 ~ CN、net 名稱 N1 ~ NM，與 public 測資相同
+******************************************************/
+
+struct Options {
+    long long cells = 10000;
+    long long nets = -1;
+    string degree = "powerlaw:2.5";
+    int maxDegree = 1000;
+    int weight = 1;
+    int libCells = 32;
+    double libSkew = 1.0;
+    double utilA = 80;
+    double utilB = 90;
+    double fill = 0.9;
+    int dies = 2;
+    int locality = 64;
+    unsigned seed = 1;
+};
+
+// 有緩衝的輸出，檔案可能有好幾 GB
+class Writer {
+    public:
+        explicit Writer(const string &filename) : fp(fopen(filename.c_str(), "wb")) {
+            if (!fp) {
+                cerr << "Cannot open output file: " << filename << endl;
+                exit(1);
+            }
+            buf.reserve(1 << 20);
+        }
+        ~Writer() {
+            flush();
+            fclose(fp);
+        }
+        Writer &operator<<(const string &s) { buf += s; check(); return *this; }
+        Writer &operator<<(const char *s) { buf += s; check(); return *this; }
+        Writer &operator<<(long long v) { buf += to_string(v); check(); return *this; }
+        void flush() {
+            if (fwrite(buf.data(), 1, buf.size(), fp) != buf.size()) {
+                cerr << "Cannot write output file" << endl;
+                exit(1);
+            }
+            buf.clear();
+        }
+    private:
+        FILE *fp;
+        string buf;
+        void check() { if (buf.size() >= (1 << 20)) flush(); }
+};
+
+
+
+// 整數就不印小數點
+static string formatNumber(double v)
+{
+    ostringstream ss;
+    ss << v;
+    return ss.str();
+}
+
+// 依 --degree 的設定抽一個 net degree
+class DegreeSampler {
+    public:
+        DegreeSampler(const string &spec, int maxDegree) : maxDegree(max(2, maxDegree)) {
+            vector<string> f;
+            stringstream ss(spec);
+            string tok;
+            while (getline(ss, tok, ':'))
+                f.push_back(tok);
+            kind = f.empty() ? "" : f[0];
+            if (kind == "fixed" && f.size() == 2) {
+                a = b = atoi(f[1].c_str());
+            }
+            else if (kind == "uniform" && f.size() == 3) {
+                a = atoi(f[1].c_str());
+                b = atoi(f[2].c_str());
+            }
+            else if (kind == "powerlaw" && f.size() == 2) {
+                // 累積分佈表，抽樣時二分搜尋
+                double alpha = atof(f[1].c_str());
+                double sum = 0;
+                for (int d = 2; d <= this->maxDegree; ++d) {
+                    sum += pow((double)d, -alpha);
+                    cdf.push_back(sum);
+                }
+                for (double &x : cdf)
+                    x /= sum;
+            }
+            else {
+                cerr << "Bad --degree: " << spec << endl;
+                exit(1);
+            }
+            a = max(1, min(a, this->maxDegree));
+            b = max(a, min(b, this->maxDegree));
+        }
+
+        int operator()(mt19937_64 &rng) {
+            if (kind == "powerlaw") {
+                double u = uniform_real_distribution<double>(0, 1)(rng);
+                return 2 + (int)(lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+            }
+            return uniform_int_distribution<int>(a, b)(rng);
+        }
+
+    private:
+        string kind;
+        int maxDegree;
+        int a = 2, b = 2;
+        vector<double> cdf;
+};
+
+
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <out.txt> [--cells N] [--nets M] [--degree SPEC] [--max-degree D]"
+             << " [--weight W] [--libcells L] [--lib-skew s] [--util-a U] [--util-b U] [--fill F]"
+             << " [--dies K] [--locality W] [--seed S]\n";
+        return 1;
+    }
+    string outFile = argv[1];
+    Options opt;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << arg << endl;
+            return 1;
+        }
+        const char *v = argv[++i];
+        if (arg == "--cells")
+            opt.cells = max(2LL, atoll(v));
+        else if (arg == "--nets")
+            opt.nets = max(0LL, atoll(v));
+        else if (arg == "--degree")
+            opt.degree = v;
+        else if (arg == "--max-degree")
+            opt.maxDegree = atoi(v);
+        else if (arg == "--weight")
+            opt.weight = max(1, atoi(v));
+        else if (arg == "--libcells")
+            opt.libCells = max(1, atoi(v));
+        else if (arg == "--lib-skew")
+            opt.libSkew = max(0.0, atof(v));
+        else if (arg == "--util-a")
+            opt.utilA = atof(v);
+        else if (arg == "--util-b")
+            opt.utilB = atof(v);
+        else if (arg == "--fill")
+            opt.fill = min(1.0, max(0.01, atof(v)));
+        else if (arg == "--dies")
+            opt.dies = max(2, atoi(v));
+        else if (arg == "--locality")
+            opt.locality = max(2, atoi(v));
+        else if (arg == "--seed")
+            opt.seed = (unsigned)strtoul(v, NULL, 10);
+        else {
+            cerr << "Unknown option: " << arg << endl;
+            return 1;
+        }
+    }
+    if (opt.nets < 0)
+        opt.nets = opt.cells;
+    long long n = opt.cells;
+    int maxDegree = (int)min<long long>(opt.maxDegree, n);
+    DegreeSampler sampleDegree(opt.degree, maxDegree);
+    mt19937_64 rng(opt.seed);
+
+    // LibCell：兩個 tech 高度固定，寬度隨機；TB 的寬度是 TA 的 0.6 ~ 1.4 倍
+    int L = opt.libCells;
+    vector<long long> widthA(L), widthB(L);
+    const long long heightA = 92, heightB = 108;
+    for (int l = 0; l < L; ++l) {
+        widthA[l] = uniform_int_distribution<long long>(40, 300)(rng);
+        widthB[l] = max(1LL, (long long)(widthA[l] * uniform_real_distribution<double>(0.6, 1.4)(rng)));
+    }
+    // lib cell 的使用頻率 ~ rank^-skew
+    vector<double> libCdf(L);
+    double sum = 0;
+    for (int l = 0; l < L; ++l) {
+        sum += pow(l + 1.0, -opt.libSkew);
+        libCdf[l] = sum;
+    }
+    vector<int> libOf(n);
+    double totalA = 0, totalB = 0;
+    uniform_real_distribution<double> unit(0, 1);
+    for (long long c = 0; c < n; ++c) {
+        int l = lower_bound(libCdf.begin(), libCdf.end(), unit(rng) * sum) - libCdf.begin();
+        libOf[c] = min(l, L - 1);
+        totalA += (double)widthA[libOf[c]] * heightA;
+        totalB += (double)widthB[libOf[c]] * heightB;
+    }
+
+    // die 大小：cell 平均分到各個 die 時，使用的面積是可用面積的 fill 倍
+    vector<pair<bool, double>> dieTech;  // (是否用 TB, util)
+    if (opt.dies == 2) {
+        dieTech.push_back(make_pair(false, opt.utilA));
+        dieTech.push_back(make_pair(true, opt.utilB));
+    }
+    else {
+        for (int d = 0; d < opt.dies; ++d)
+            dieTech.push_back(make_pair(d % 2 == 1, d % 2 ? opt.utilB : opt.utilA));
+    }
+    double dieArea = 0;
+    for (auto &dt : dieTech)
+        dieArea = max(dieArea, (dt.first ? totalB : totalA) / opt.dies / (dt.second / 100.0) / opt.fill);
+    long long side = (long long)ceil(sqrt(dieArea));
+
+    Writer out(outFile);
+    out << "NumTechs 2\n";
+    for (int t = 0; t < 2; ++t) {
+        out << "Tech " << (t ? "TB " : "TA ") << (long long)L << "\n";
+        for (int l = 0; l < L; ++l)
+            out << "LibCell MC" << (long long)(l + 1) << " " << (t ? widthB[l] : widthA[l]) << " "
+                << (t ? heightB : heightA) << "\n";
+    }
+    out << "\nDieSize " << side << " " << side << "\n";
+    if (opt.dies == 2) {
+        out << "DieA TA " << formatNumber(opt.utilA) << "\n";
+        out << "DieB TB " << formatNumber(opt.utilB) << "\n";
+    }
+    else {
+        out << "NumDies " << (long long)opt.dies << "\n";
+        for (int d = 0; d < opt.dies; ++d)
+            out << "Die D" << (long long)d << (dieTech[d].first ? " TB " : " TA ") << formatNumber(dieTech[d].second) << "\n";
+    }
+
+    out << "\nNumCells " << n << "\n";
+    for (long long c = 0; c < n; ++c)
+        out << "Cell C" << c + 1 << " MC" << (long long)(libOf[c] + 1) << "\n";
+
+    // net：以隨機的 cell 為中心，pin 大多落在 locality 範圍內，少數 (約 5%) 是任意的 cell
+    out << "\nNumNets " << opt.nets << "\n";
+    vector<long long> pins;
+    unordered_set<long long> seen;
+    for (long long e = 0; e < opt.nets; ++e) {
+        int deg = sampleDegree(rng);
+        long long window = max<long long>(opt.locality, 2LL * deg);
+        long long center = uniform_int_distribution<long long>(0, n - 1)(rng);
+        pins.clear();
+        seen.clear();
+        while ((int)pins.size() < deg) {
+            long long c;
+            if (unit(rng) < 0.05)
+                c = uniform_int_distribution<long long>(0, n - 1)(rng);
+            else
+                c = ((center + uniform_int_distribution<long long>(-window / 2, window / 2)(rng)) % n + n) % n;
+            if (seen.insert(c).second)
+                pins.push_back(c);
+        }
+        long long w = uniform_int_distribution<int>(1, opt.weight)(rng);
+        out << "Net N" << e + 1 << " " << (long long)deg << " " << w << "\n";
+        for (long long c : pins)
+            out << "Cell C" << c + 1 << "\n";
+    }
+    return 0;
+}
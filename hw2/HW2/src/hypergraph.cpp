@@ -0,0 +1,37 @@
+#include "hypergraph.h"
+
+int Hypergraph::addCell(string_view name)
+{
+    cellNames.push_back(name);
+    return numCells++;
+}
+
+int Hypergraph::addNet(string_view name, int weight)
+{
+    netNames.push_back(name);
+    netWeight.push_back(weight);
+    netCellStart.push_back(netCellStart.back());
+    return numNets++;
+}
+
+void Hypergraph::addPin(int cellId)
+{
+    netCells.push_back(cellId);
+    ++netCellStart.back();
+}
+
+void Hypergraph::buildCellNets()
+{
+    // counting sort: 先數每個 cell 的 degree，再做 prefix sum
+    cellNetStart.assign(numCells + 1, 0);
+    for (int c : netCells)
+        ++cellNetStart[c + 1];
+    for (int c = 0; c < numCells; ++c)
+        cellNetStart[c + 1] += cellNetStart[c];
+
+    cellNets.resize(netCells.size());
+    vector<int> fill(cellNetStart.begin(), cellNetStart.end() - 1);
+    for (int e = 0; e < numNets; ++e)
+        for (int p = netCellStart[e]; p < netCellStart[e + 1]; ++p)
+            cellNets[fill[netCells[p]]++] = e;
+}
@@ -0,0 +1,49 @@
+#ifndef HYPERGRAPH_H
+#define HYPERGRAPH_H
+
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+/************************************
+ * Hypergraph:
+ *   以 dense ID (0 ~ n-1) 表示整個 netlist，
+ *   pin 以 CSR (compressed sparse row) 存放：
+ *     cell c 連接的 nets  = cellNets[cellNetStart[c] .. cellNetStart[c+1])
+ *     net  e 連接的 cells = netCells[netCellStart[e] .. netCellStart[e+1])
+ *   FM 全程只用整數 ID，名稱只在讀寫檔時使用
+ ************************************/
+class Hypergraph {
+    public:
+        int numCells;
+        int numNets;
+
+        vector<int> cellNetStart;  // size = numCells + 1
+        vector<int> cellNets;      // cell -> nets
+        vector<int> netCellStart;  // size = numNets + 1
+        vector<int> netCells;      // net -> cells
+        vector<int> netWeight;
+
+        // 名稱指向 Parser mmap 的輸入檔 (粗化出來的 Hypergraph 沒有名稱)
+        vector<string_view> cellNames;  // 例如 "C1"
+        vector<string_view> netNames;   // 例如 "N1"
+
+        Hypergraph() : numCells(0), numNets(0) { netCellStart.push_back(0); }
+
+        int addCell(string_view name);
+        // 開一條新的 net，之後用 addPin 加入它的 cell
+        int addNet(string_view name, int weight);
+        void addPin(int cellId);
+        // 所有 net 讀完後，由 net -> cells 轉置出 cell -> nets
+        void buildCellNets();
+
+        int cellDegree(int c) const { return cellNetStart[c + 1] - cellNetStart[c]; }
+        int netDegree(int e) const { return netCellStart[e + 1] - netCellStart[e]; }
+        const int *cellNetBegin(int c) const { return cellNets.data() + cellNetStart[c]; }
+        const int *cellNetEnd(int c) const { return cellNets.data() + cellNetStart[c + 1]; }
+        const int *netCellBegin(int e) const { return netCells.data() + netCellStart[e]; }
+        const int *netCellEnd(int e) const { return netCells.data() + netCellStart[e + 1]; }
+};
+
+#endif // HYPERGRAPH_H
@@ -0,0 +1,316 @@
+#include <bits/stdc++.h>
+#include "kway.h"
+#include "verify.h"
+using namespace std;
+
+KWayFM::KWayFM(const Hypergraph &hg, const vector<vector<double>> &area, const vector<double> &maxArea)
+    : hg(hg), K(area.size()), area(area), maxArea(maxArea),
+      cutSize(0), Pmax(0), initCutSize(0), bestPass(0), earlyExit(0), largeNetDegree(0), budget(NULL), ready(false)
+{
+    // Pmax: 所有 cell 中，連接 net 權重和的最大值 (gain 一樣落在 [-Pmax, Pmax])
+    for (int c = 0; c < hg.numCells; ++c) {
+        int sumWeight = 0;
+        for (const int *e = hg.cellNetBegin(c); e != hg.cellNetEnd(c); ++e)
+            sumWeight += hg.netWeight[*e];
+        if (sumWeight > Pmax)
+            Pmax = sumWeight;
+    }
+
+    partition.assign(hg.numCells, 0);
+    partSize.assign(K, 0.0);
+    gain.assign((size_t)hg.numCells * K, 0);
+    pinCount.assign((size_t)hg.numNets * K, 0);
+    idXor.assign((size_t)hg.numNets * K, 0);
+    lock.assign(hg.numCells, 0);
+    // 搬到 die t 的 cell 佔 area[t]
+    buckets.reserve(K);
+    for (int t = 0; t < K; ++t)
+        buckets.push_back(Bucket(to_string(t), Pmax, area[t]));
+}
+
+
+
+void KWayFM::initSolution()
+{
+    vector<double> used(K, 0.0);
+    int p = 0;
+    for (int c = 0; c < hg.numCells; ++c) {
+        while (p < K && used[p] + area[p][c] > maxArea[p])
+            ++p;
+        int to = p;
+        if (to == K) {
+            // 所有 die 都放不下 (面積很緊)，放到剩餘空間最多的 die，留給 FM 修正
+            to = 0;
+            for (int t = 1; t < K; ++t)
+                if (maxArea[t] - used[t] - area[t][c] > maxArea[to] - used[to] - area[to][c])
+                    to = t;
+            p = K - 1;
+        }
+        partition[c] = to;
+        used[to] += area[to][c];
+    }
+    cutSize = recalcCutSize();
+    ready = false;
+}
+
+void KWayFM::setPartition(const vector<int> &part)
+{
+    partition = part;
+    cutSize = recalcCutSize();
+    ready = false;
+}
+
+
+
+int KWayFM::recalcCutSize()
+{
+    fill(pinCount.begin(), pinCount.end(), 0);
+    fill(idXor.begin(), idXor.end(), 0);
+    fill(partSize.begin(), partSize.end(), 0.0);
+    for (int c = 0; c < hg.numCells; ++c)
+        partSize[partition[c]] += area[partition[c]][c];
+
+    int cut = 0;
+    for (int e = 0; e < hg.numNets; ++e) {
+        int *cnt = &pinCount[(size_t)e * K];
+        int *x = &idXor[(size_t)e * K];
+        for (const int *c = hg.netCellBegin(e); c != hg.netCellEnd(e); ++c) {
+            ++cnt[partition[*c]];
+            x[partition[*c]] ^= *c;
+        }
+        int span = 0;
+        for (int p = 0; p < K; ++p)
+            span += cnt[p] > 0;
+        if (span > 1)
+            cut += hg.netWeight[e] * (span - 1);
+    }
+    return cut;
+}
+
+bool KWayFM::isFeasible() const
+{
+    for (int p = 0; p < K; ++p)
+        if (partSize[p] > maxArea[p])
+            return false;
+    return true;
+}
+
+
+
+/******************************************************
+  依目前的 net 計數算出每顆 cell 搬到每個 die 的 gain，並放進 bucket
+  (net 計數由 recalcCutSize 建好)
+******************************************************/
+void KWayFM::initGainAndBuckets()
+{
+    PROFILE_SCOPE(PhaseInitGain);
+    fill(gain.begin(), gain.end(), 0);
+    fill(lock.begin(), lock.end(), 0);
+    for (int c = 0; c < hg.numCells; ++c) {
+        int *g = &gain[(size_t)c * K];
+        int from = partition[c];
+        for (const int *e = hg.cellNetBegin(c); e != hg.cellNetEnd(c); ++e) {
+            const int *cnt = &pinCount[(size_t)*e * K];
+            int weight = hg.netWeight[*e];
+            int benefit = cnt[from] == 1 ? weight : 0;
+            // 大 net 不算「目標 die 上沒有 pin」那一項 (同 FM::largeNetDegree)
+            bool large = isLargeNet(*e);
+            for (int t = 0; t < K; ++t)
+                g[t] += benefit - (cnt[t] == 0 && !large ? weight : 0);
+        }
+    }
+
+    for (int t = 0; t < K; ++t)
+        buckets[t].clearList();
+    for (int c = 0; c < hg.numCells; ++c)
+        for (int t = 0; t < K; ++t)
+            if (t != partition[c])
+                buckets[t].insert(c, gain[(size_t)c * K + t] + Pmax);
+}
+
+
+
+// 在 buckets[t] 的 gain index i 串列中，找第一顆搬到 die t 後放得下的 cell
+// (搬出的 die 面積只會變小，不用檢查)
+int KWayFM::findFeasible(int t, int i)
+{
+    double room = maxArea[t] - partSize[t];
+    return buckets[t].firstFit(i, [room](double a){ return a <= room; });
+}
+
+/******************************************************
+  在 K 個 bucket 中選 gain 最大且放得下的 (cell, 目標 die)
+  gain 相同時優先搬到面積使用率較低的 die
+******************************************************/
+int KWayFM::cellSelect(int &to)
+{
+    PROFILE_COUNT(selects, 1);
+    vector<int> index(K);
+    for (int t = 0; t < K; ++t)
+        index[t] = buckets[t].maxIndex;
+
+    while (true) {
+        int best = -1;
+        for (int t = 0; t < K; ++t) {
+            if (index[t] < 0)
+                continue;
+            if (best == -1 || index[t] > index[best] ||
+                (index[t] == index[best] && partSize[t] * maxArea[best] < partSize[best] * maxArea[t]))
+                best = t;
+        }
+        if (best == -1)
+            return -1;
+        int c = findFeasible(best, index[best]);
+        if (c != -1) {
+            to = best;
+            return c;
+        }
+        PROFILE_COUNT(infeasibleSkips, buckets[best].listHead[index[best]] != -1);
+        --index[best];
+    }
+}
+
+
+
+void KWayFM::addGain(int c, int t, int change)
+{
+    int &g = gain[(size_t)c * K + t];
+    buckets[t].remove(c, g + Pmax);
+    g += change;
+    buckets[t].insert(c, g + Pmax);
+}
+
+/******************************************************
+  cell c 由所在的 die 搬到 die to，更新 net 計數、其他 cell 的 gain 與 cutSize
+  對每條 net e (from -> to)：
+    1. e 在 from 沒有 pin 了：其他 cell 搬到 from 的 gain -w，cut -w
+    2. e 在 from 只剩一顆：那顆 cell 搬到任何 die 的 gain +w
+    3. e 原本在 to 沒有 pin：其他 cell 搬到 to 的 gain +w，cut +w
+    4. e 原本在 to 只有一顆：那顆 cell 搬到任何 die 的 gain -w
+  只剩一顆的 cell 由 ID XOR 直接得到，只有 1、3 要走訪整條 net (大 net 跳過)
+******************************************************/
+void KWayFM::moveCell(int c, int to)
+{
+    int from = partition[c];
+    for (int t = 0; t < K; ++t)
+        if (t != from)
+            buckets[t].remove(c, gain[(size_t)c * K + t] + Pmax);
+    partition[c] = to;
+    lock[c] = 1;
+    partSize[from] -= area[from][c];
+    partSize[to] += area[to][c];
+
+    for (const int *e = hg.cellNetBegin(c); e != hg.cellNetEnd(c); ++e) {
+        int netId = *e;
+        int *cnt = &pinCount[(size_t)netId * K];
+        int *x = &idXor[(size_t)netId * K];
+        int weight = hg.netWeight[netId];
+        bool large = isLargeNet(netId);
+        PROFILE_NET(hg.netDegree(netId));
+
+        --cnt[from];
+        x[from] ^= c;
+        if (cnt[from] == 0) {
+            cutSize -= weight;
+            if (!large)
+                for (const int *u = hg.netCellBegin(netId); u != hg.netCellEnd(netId); ++u)
+                    if (!lock[*u]) {
+                        addGain(*u, from, -weight);
+                        PROFILE_GAIN(hg.netDegree(netId), 1);
+                    }
+        }
+        else if (cnt[from] == 1 && !lock[x[from]]) {
+            int critical = x[from];
+            for (int t = 0; t < K; ++t)
+                if (t != from)
+                    addGain(critical, t, weight);
+            PROFILE_GAIN(hg.netDegree(netId), K - 1);
+        }
+
+        if (cnt[to] == 0) {
+            cutSize += weight;
+            if (!large)
+                for (const int *u = hg.netCellBegin(netId); u != hg.netCellEnd(netId); ++u)
+                    if (!lock[*u]) {
+                        addGain(*u, to, weight);
+                        PROFILE_GAIN(hg.netDegree(netId), 1);
+                    }
+        }
+        else if (cnt[to] == 1 && !lock[x[to]]) {
+            int critical = x[to];
+            for (int t = 0; t < K; ++t)
+                if (t != to)
+                    addGain(critical, t, -weight);
+            PROFILE_GAIN(hg.netDegree(netId), K - 1);
+        }
+        ++cnt[to];
+        x[to] ^= c;
+    }
+}
+
+// 依 move log 反向撤銷 bestPass 之後的移動 (net 計數與 gain 留到下一個 pass 重建)
+void KWayFM::rollback()
+{
+    PROFILE_SCOPE(PhaseRecalcAfterBestPass);
+    for (int k = (int)move.size() - 1; k >= bestPass; --k) {
+        int c = move[k].first;
+        int from = move[k].second;
+        int to = partition[c];
+        partSize[to] -= area[to][c];
+        partSize[from] += area[from][c];
+        partition[c] = from;
+    }
+    ready = false;
+}
+
+
+
+int KWayFM::runPass()
+{
+    // 時間已經用完：不動目前的解
+    if (budget && budget->expired())
+        return 0;
+    if (!ready) {
+        cutSize = recalcCutSize();
+        initGainAndBuckets();
+        ready = true;
+    }
+    initCutSize = cutSize;
+
+    int pass = 0;
+    int minCutSize = cutSize;
+    bestPass = 0;
+    move.clear();
+
+    PROFILE_START(selectMove);
+    int to = -1;
+    int target = cellSelect(to);
+    while (target != -1) {
+        ++pass;
+        PROFILE_COUNT(moves, 1);
+        move.push_back(make_pair(target, partition[target]));
+        moveCell(target, to);
+        if (minCutSize > cutSize) {
+            minCutSize = cutSize;
+            bestPass = pass;
+        }
+        if (earlyExit > 0 && pass - bestPass >= earlyExit)
+            break;
+        if (budget && pass % budgetCheckInterval == 0 && budget->expired())
+            break;
+        target = cellSelect(to);
+    }
+    PROFILE_STOP(selectMove, PhaseSelectMove);
+
+    rollback();
+    cutSize = minCutSize;
+    assert(cutSize == computeKWayCutSize(hg, partition));
+    return initCutSize - cutSize;
+}
+
+void KWayFM::refine(int maxPasses)
+{
+    for (int p = 0; p < maxPasses; ++p)
+        if (runPass() <= 0)
+            break;
+}
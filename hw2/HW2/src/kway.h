@@ -0,0 +1,79 @@
+#ifndef KWAY_H
+#define KWAY_H
+
+#include <vector>
+#include "lib.h"
+#include "hypergraph.h"
+#include "budget.h"
+
+using namespace std;
+
+/************************************
+ * KWayFM:
+ *   K 個 die (多層堆疊) 的 FM 引擎，每個 die 有自己的 tech (cell 面積) 與面積上限
+ *   cut 以 connectivity 計：每條 net 的 weight * (跨越的 die 數 - 1)，K = 2 時就是一般的 cut size
+ *   partition[c]: cell c 所在的 die (0 ~ K-1)
+ *
+ *   每條 net 在各個 die 的 pin 數與 cell ID XOR 存成 numNets x K 的連續矩陣 (一條 net 一列)
+ *   cell c 搬到 die t 的 gain:
+ *     + c 是所在 die 唯一 pin 的 net 權重和 (搬走後這條 net 少跨一個 die)
+ *     - t 上沒有 pin 的 net 權重和 (搬過去後這條 net 多跨一個 die)
+ *   buckets[t] 放所有不在 t 的 cell，依「搬到 t」的 gain 排列；每顆 cell 在 K-1 個 bucket 裏
+ ************************************/
+class KWayFM {
+    public:
+        const Hypergraph &hg;
+        int K;
+        const vector<vector<double>> &area;  // area[p][c]: cell c 放在 die p 時的面積
+        vector<double> maxArea;              // 每個 die 的面積上限
+
+        vector<int> partition;
+        vector<double> partSize;  // 每個 die 目前的面積
+        int cutSize;              // 目前 partition 的 connectivity cut
+        int Pmax;
+
+        // 上一個 pass 的統計 (給 main 印出來用)
+        int initCutSize;
+        int bestPass;
+
+        vector<Bucket> buckets;  // 一個 die 一個 bucket
+
+        // 意義與 FM 相同
+        int earlyExit;
+        int largeNetDegree;
+        const TimeBudget *budget;
+        static const int budgetCheckInterval = 256;
+
+    public:
+        KWayFM(const Hypergraph &hg, const vector<vector<double>> &area, const vector<double> &maxArea);
+
+        // 初始化解：依 cell ID 順序填滿 die 0，再填 die 1 ...，都放不下就放剩餘空間最多的 die
+        void initSolution();
+        void setPartition(const vector<int> &part);
+
+        // 做一個 FM pass，結束後 partition 回到 bestPass 的分割，回傳這個 pass 減少的 cut
+        int runPass();
+        void refine(int maxPasses);
+
+        // 依目前 partition 重新計算 net 計數、各 die 面積與 cut
+        int recalcCutSize();
+        bool isFeasible() const;
+
+    private:
+        vector<int> gain;      // gain[c * K + t]: cell c 搬到 die t 的 gain
+        vector<int> pinCount;  // pinCount[e * K + p]: net e 在 die p 的 pin 數
+        vector<int> idXor;     // idXor[e * K + p]: net e 在 die p 的 cell ID XOR (只剩一顆時就是那顆)
+        vector<char> lock;
+        vector<pair<int, int> > move;  // move log: (cell ID, from)
+        bool ready;  // gain / bucket / net 計數是否對應目前的 partition
+
+        void initGainAndBuckets();
+        int findFeasible(int t, int i);
+        int cellSelect(int &to);
+        void moveCell(int c, int to);
+        void addGain(int c, int t, int change);
+        bool isLargeNet(int e) const { return largeNetDegree > 0 && hg.netDegree(e) > largeNetDegree; }
+        void rollback();
+};
+
+#endif // KWAY_H
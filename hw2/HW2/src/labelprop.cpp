@@ -0,0 +1,199 @@
+#include <bits/stdc++.h>
+#include "labelprop.h"
+#include "verify.h"
+#include "profile.h"
+using namespace std;
+
+LabelPropagation::LabelPropagation(const Hypergraph &hg, const vector<double> &areaA, const vector<double> &areaB,
+                                   double maxAreaA, double maxAreaB)
+    : numThreads(1), maxRounds(16), budget(NULL), batches(0), moves(0), revertedBatches(0),
+      hg(hg), areaA(areaA), areaB(areaB), pinCount((size_t)hg.numNets * 2)
+{
+    maxArea[0] = maxAreaA;
+    maxArea[1] = maxAreaB;
+}
+
+
+
+// 在 side 預約面積 a，放不下就回傳 false (不會改動 used)
+bool LabelPropagation::reserve(int side, double a)
+{
+    double cur = used[side].load(memory_order_relaxed);
+    do {
+        if (cur + a > maxArea[side])
+            return false;
+    } while (!used[side].compare_exchange_weak(cur, cur + a, memory_order_relaxed));
+    return true;
+}
+
+void LabelPropagation::release(int side, double a)
+{
+    double cur = used[side].load(memory_order_relaxed);
+    while (!used[side].compare_exchange_weak(cur, cur - a, memory_order_relaxed))
+        ;
+}
+
+// 與 FM::computeGain 相同的規則，計數由 atomic 讀出 (可能是別的 thread 搬到一半的值)
+int LabelPropagation::gain(int c, int side) const
+{
+    int g = 0;
+    for (const int *e = hg.cellNetBegin(c); e != hg.cellNetEnd(c); ++e) {
+        int here = pinCount[2 * *e + side].load(memory_order_relaxed);
+        int there = pinCount[2 * *e + !side].load(memory_order_relaxed);
+        if (here == 1 && there > 0)
+            g += hg.netWeight[*e];
+        else if (there == 0 && here > 1)
+            g -= hg.netWeight[*e];
+    }
+    return g;
+}
+
+// cell c 由 from 搬到另一邊 (partition[c] 只有負責 c 的 thread 會寫)，回傳 cut 的變化
+// (只在同一個 batch 的移動方向都相同時，各 thread 回傳值的總和才是精確的)
+int LabelPropagation::moveCell(vector<char> &partition, int c, int from)
+{
+    partition[c] = !from;
+    int delta = 0;
+    for (const int *e = hg.cellNetBegin(c); e != hg.cellNetEnd(c); ++e) {
+        if (pinCount[2 * *e + from].fetch_sub(1, memory_order_relaxed) == 1)
+            delta -= hg.netWeight[*e];
+        if (pinCount[2 * *e + !from].fetch_add(1, memory_order_relaxed) == 0)
+            delta += hg.netWeight[*e];
+    }
+    return delta;
+}
+
+
+
+// 一個 thread：一次拿一段 active cell，把 from 邊 gain > 0 且放得下的 cell 搬過去
+void LabelPropagation::work(vector<char> &partition, int from, Batch &batch)
+{
+    int to = !from;
+    int n = active.size();
+    while (true) {
+        int begin = nextBlock.fetch_add(blockSize, memory_order_relaxed);
+        if (begin >= n)
+            break;
+        int end = min(n, begin + blockSize);
+        for (int k = begin; k < end; ++k) {
+            int c = active[k];
+            if (partition[c] != from || gain(c, from) <= 0)
+                continue;
+            if (!reserve(to, area(c, to)))
+                continue;
+            batch.delta += moveCell(partition, c, from);
+            release(from, area(c, from));
+            batch.moved.push_back(c);
+        }
+    }
+}
+
+long long LabelPropagation::runBatch(vector<char> &partition, int from, vector<Batch> &results)
+{
+    nextBlock.store(0);
+    for (Batch &b : results) {
+        b.moved.clear();
+        b.delta = 0;
+    }
+    if (numThreads <= 1) {
+        work(partition, from, results[0]);
+    }
+    else {
+        vector<thread> threads;
+        for (int t = 1; t < numThreads; ++t)
+            threads.emplace_back(&LabelPropagation::work, this, ref(partition), from, ref(results[t]));
+        work(partition, from, results[0]);
+        for (auto &th : threads)
+            th.join();
+    }
+    long long count = 0;
+    for (Batch &b : results)
+        count += b.moved.size();
+    return count;
+}
+
+
+
+void LabelPropagation::refine(vector<char> &partition, int &cutSize)
+{
+    PROFILE_SCOPE(PhaseLabelPropagation);
+    batches = 0;
+    moves = 0;
+    revertedBatches = 0;
+    numThreads = max(1, numThreads);
+
+    // net 計數與兩邊的面積 (之後只在 batch 裏增量更新)
+    for (int e = 0; e < hg.numNets; ++e) {
+        int ones = 0;
+        for (const int *c = hg.netCellBegin(e); c != hg.netCellEnd(e); ++c)
+            ones += partition[*c];
+        pinCount[2 * e].store(hg.netDegree(e) - ones, memory_order_relaxed);
+        pinCount[2 * e + 1].store(ones, memory_order_relaxed);
+    }
+    double usedArea[2] = {0.0, 0.0};
+    for (int c = 0; c < hg.numCells; ++c)
+        usedArea[(int)partition[c]] += area(c, partition[c]);
+    used[0].store(usedArea[0]);
+    used[1].store(usedArea[1]);
+
+    // 一開始 active 的是被切的 net 上的 cell
+    vector<char> mark(hg.numCells, 0);
+    vector<int> next;
+    auto activate = [&](int e) {
+        for (const int *v = hg.netCellBegin(e); v != hg.netCellEnd(e); ++v) {
+            if (!mark[*v]) {
+                mark[*v] = 1;
+                next.push_back(*v);
+            }
+        }
+    };
+    for (int e = 0; e < hg.numNets; ++e)
+        if (pinCount[2 * e].load(memory_order_relaxed) && pinCount[2 * e + 1].load(memory_order_relaxed))
+            activate(e);
+
+    vector<Batch> results(numThreads);
+    for (int round = 0; round < maxRounds; ++round) {
+        for (int c : next)
+            mark[c] = 0;
+        sort(next.begin(), next.end());
+        active.swap(next);
+        next.clear();
+        if (active.empty())
+            break;
+
+        int roundCut = cutSize;
+        for (int from = 0; from < 2; ++from) {
+            if (budget && budget->expired())
+                return;
+            long long count = runBatch(partition, from, results);
+            ++batches;
+            int delta = 0;
+            for (const Batch &b : results)
+                delta += b.delta;
+            if (delta > 0) {
+                // gain 估錯讓 cut 變大：整個 batch 搬回去
+                for (const Batch &b : results) {
+                    for (int c : b.moved) {
+                        moveCell(partition, c, !from);
+                        release(!from, area(c, !from));
+                        used[from].store(used[from].load() + area(c, from));
+                    }
+                }
+                ++revertedBatches;
+                assert(cutSize == computeCutSize(hg, partition));
+                return;
+            }
+            cutSize += delta;
+            moves += count;
+            assert(cutSize == computeCutSize(hg, partition));
+            // 被搬的 cell 的鄰居 gain 可能變了，下一個 round 再看
+            for (const Batch &b : results)
+                for (int c : b.moved)
+                    for (const int *e = hg.cellNetBegin(c); e != hg.cellNetEnd(c); ++e)
+                        activate(*e);
+        }
+        // 整個 round 沒有讓 cut 變小 (只剩 gain 估錯、互相抵消的移動)
+        if (cutSize >= roundCut)
+            break;
+    }
+}
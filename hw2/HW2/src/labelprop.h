@@ -0,0 +1,72 @@
+#ifndef LABELPROP_H
+#define LABELPROP_H
+
+#include <atomic>
+#include <vector>
+#include "hypergraph.h"
+#include "budget.h"
+
+using namespace std;
+
+/************************************
+ * LabelPropagation:
+ *   平行的 refinement (類似 Mt-KaHyPar 的 label propagation)，在 FM 之前先用多個 thread 把 cut 快速降下來
+ *   只看 active 的 cell：一開始是被切的 net 上的 cell，之後是上一個 round 被搬的 cell 的鄰居
+ *   一個 batch 只搬某一邊的 cell (兩邊交替)，相連的 cell 不會同時往對方那邊搬而互相抵消
+ *   每個 thread 每次拿一段 active cell (彼此不重疊)，用目前的 net 計數 (atomic) 算 gain，
+ *   gain > 0 且另一邊的面積預約成功 (atomic CAS，不會超過 maxArea) 就直接搬，並更新 net 計數
+ *   gain 是用別的 thread 可能正在改的計數算的，不一定準，所以每個 batch 都重新確認 cut：
+ *     同一個 batch 的移動方向都相同，net 在目標邊的計數由 0 變 1 時 cut +w、
+ *     在來源邊由 1 變 0 時 cut -w，由 atomic 的回傳值就能得到這個 batch 精確的 cut 變化
+ *   cut 變大就把整個 batch 撤銷並結束
+ *   多個 thread 時結果與排程有關，1 個 thread 時結果固定
+ ************************************/
+class LabelPropagation {
+    public:
+        // 每個 thread 一次拿這麼多顆 cell
+        static const int blockSize = 1024;
+
+        int numThreads;
+        int maxRounds;              // 一個 round = 兩個 batch (先 DieA -> DieB 再反過來)
+        const TimeBudget *budget;   // NULL => 不限時，用完時不再開始新的 batch
+
+        // 上一次 refine 的統計
+        int batches;
+        long long moves;
+        int revertedBatches;
+
+    public:
+        LabelPropagation(const Hypergraph &hg, const vector<double> &areaA, const vector<double> &areaB,
+                         double maxAreaA, double maxAreaB);
+
+        // 從 partition 出發做到一個 round 沒有改善或做滿 maxRounds 為止
+        // cutSize 是 partition 目前的 cut，結束時更新成新的 cut
+        void refine(vector<char> &partition, int &cutSize);
+
+    private:
+        const Hypergraph &hg;
+        const vector<double> &areaA;
+        const vector<double> &areaB;
+        double maxArea[2];
+
+        // 一個 thread 在一個 batch 裏的結果
+        struct Batch {
+            vector<int> moved;
+            int delta;  // cut 的變化
+        };
+
+        vector<atomic<int>> pinCount;  // pinCount[e * 2 + s]: net e 在 side s 的 pin 數
+        atomic<double> used[2];        // 兩邊目前的面積 (含已預約的)
+        vector<int> active;            // 這個 round 要看的 cell (依 ID 排序)
+        atomic<int> nextBlock;         // active 中下一段還沒有 thread 拿走的位置
+
+        double area(int c, int side) const { return side ? areaB[c] : areaA[c]; }
+        bool reserve(int side, double a);
+        void release(int side, double a);
+        int gain(int c, int side) const;
+        int moveCell(vector<char> &partition, int c, int from);
+        void work(vector<char> &partition, int from, Batch &batch);
+        long long runBatch(vector<char> &partition, int from, vector<Batch> &results);
+};
+
+#endif // LABELPROP_H
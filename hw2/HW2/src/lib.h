@@ -2,9 +2,10 @@
 #define LIB_H
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <list>
-#include <set>
+#include <algorithm>
+#include "profile.h"
 
 using namespace std;
 
@@ -15,10 +16,11 @@ using namespace std;
  ************************************/
 struct LibraryCell {
     string name;  // 例如 "MC1"
+    int id;       // dense lib cell ID，同名的 LibCell 在各個 tech 中 ID 相同
     double width;
     double height;
-    LibraryCell(const string &n, double w, double h)
-        : name(n), width(w), height(h) {}
+    LibraryCell(const string &n, int i, double w, double h)
+        : name(n), id(i), width(w), height(h) {}
 };
 
 /************************************
@@ -27,8 +29,10 @@ struct LibraryCell {
  *   1. 它是用哪一種 Technology
  *   2. Die 的寬、高 (可推算面積)
  *   3. Die 的最大利用率(百分比)
+ *   4. 輸出檔中的名稱 (DieA / DieB，或多層堆疊時 "Die <name> ..." 指定的名稱)
  ************************************/
 struct Die {
+    string name;      // 例如 "DieA"
     string techName;  // 例如 "TA" or "TB"
     double width;
     double height;
@@ -46,76 +50,297 @@ struct Die {
     Die() : width(0), height(0), util(100.0) {}
     Die(const string &tech, double w, double h, double u)
         : techName(tech), width(w), height(h), util(u) {}
+    Die(const string &n, const string &tech, double w, double h, double u)
+        : name(n), techName(tech), width(w), height(h), util(u) {}
 };
 
 
 class Cell {
     public:
-        string name;         // 例如 "C1"
-        string libCellName;  // 例如 "MC1"
-    
-        // 放在 DieA / DieB 時對應的面積
-        double areaA;             
-        double areaB;             
-    
-        // FM 演算法需要的欄位
-        bool partition;  // 0 => DieA, 1 => DieB
-        int gain;
-        bool lock;
-    
-        // 連接的 net 名稱
-        vector<string> nets;
-    
-        // 在 bucket list 裏存放的位置 (iterator)
-        // 當前這個 cell 位於哪個 gain bucket，就可以透過 it 直接移除或移動
-        list<Cell*>::iterator it;
+        int id;                   // Hypergraph 裏的 dense cell ID
+        string_view name;         // 例如 "C1" (指向 Parser mmap 的輸入檔)
+        int libCellId;            // 對應 LibraryCell::id
     
         // 建構子
-        Cell(const string &n, const string &lib)
-            : name(n), libCellName(lib),
-              areaA(0), areaB(0),
-              partition(false), gain(0), lock(false) {}
+        // 在 DieA / DieB 的面積不存在 Cell 裏，而是依 cell ID 放在 areaA / areaB 兩個陣列 (見 computeCellAreas)
+        Cell(int i, string_view n, int lib)
+            : id(i), name(n), libCellId(lib) {}
 };
 
+// net 的名稱、weight 與連接的 cells 都放在 Hypergraph (以 net ID 索引)，
+// 這裡只留 FM 過程中會變動的計數
 class Net {
     public:
-        string name;    
-        int weight;          // 新的 spec 裏 net 有 weight
         int cntBucket[2];    // partition0/1 裏有多少 cell
+        int idXor[2];        // partition0/1 裏所有 cell ID 的 XOR，cntBucket[s] == 1 時就是那顆 cell
         bool lock[2];        // FM 更新中使用
-        vector<string> cells; // net下所有 cell 名稱
     
-        Net(const string &n, int w)
-            : name(n), weight(w)
+        Net()
         {
             cntBucket[0] = cntBucket[1] = 0;
+            idXor[0] = idXor[1] = 0;
             lock[0] = lock[1] = false;
         }
 };
 
 
 
+/************************************
+ * Bucket:
+ *   gain bucket 用 intrusive 雙向串列實作：
+ *   listHead[i] 是 gain index = i 的第一顆 cell ID (後插入的在前面)，
+ *   node (prev/next/stamp) 以 cell ID 索引，建構時一次配置好，
+ *   之後的插入、移除都不需要配置記憶體，皆為 O(1)
+ *
+ *   面積索引：另一邊快滿時，gain 串列前面的 cell 可能大多搬不過去，
+ *   所以每個 gain index 再依 cell 搬到另一邊後佔的面積 (toArea) 分成 numClasses 個類別，
+ *   head[i * numClasses + k] 是 gain index = i、面積類別 = k 的第一顆 cell，
+ *   classMask[i] 的第 k 個 bit 表示該串列非空
+ *   類別依 toArea 由小到大排列，classUpper[k] 是類別 k 內最大的 toArea，
+ *   所以「搬過去放得下」的類別一定是前綴，可以二分搜尋 (見 FM::findFeasible)
+ *   面積索引第一次用到時才建立 (buildIndex)，之後與 gain 串列一起維護，clearList 時捨棄
+ *   node[c].stamp 是 cell c 插入的順序，用來在不同類別之間找出 gain 串列上最前面的候選
+ ************************************/
 class Bucket {
     public:
-        vector<list<Cell*>> bucketList;
-        set<string> bucketSet; // 存放屬於這個分割區域的所有 cell 名稱
+        // 面積類別數的上限 (classMask 用一個 64-bit 整數)
+        static const int maxClasses = 64;
+        // firstFit 在一個 gain 串列中連續這麼多顆 cell 都放不下時，才建立面積索引
+        static const int scanLimit = 32;
+
+        // 每顆 cell 在 gain 串列上的資料放在一起 (插入 / 移除時只碰到一條 cache line)
+        struct Node {
+            int prev;                  // 串列中的前後 cell (-1 表示沒有)
+            int next;
+            unsigned long long stamp;  // 插入的順序，越大越晚插入
+        };
+        // 面積類別串列的資料
+        struct ClassNode {
+            int prev;
+            int next;
+            int areaClass;             // 在這個 bucket 的面積類別
+        };
+
+        vector<int> listHead;  // 每個 gain index 的串列開頭 (-1 表示空)
+        vector<Node> node;     // node[c]: cell c 在 gain 串列上的資料
+        unsigned long long clock;
+
+        bool indexed;          // 面積索引是否已建立
+        int numClasses;        // 0 表示類別還沒決定
+        vector<int> head;      // 每個 (gain index, 面積類別) 的串列開頭 (-1 表示空)
+        vector<unsigned long long> classMask;  // 每個 gain index 哪些面積類別非空
+        vector<ClassNode> classNode;  // classNode[c]: cell c 在面積類別串列上的資料
+        vector<double> classUpper;   // 每個面積類別最大的 toArea (遞增)
+        bool exactClasses;           // 每個類別只有一種 toArea
+        double maxToArea;            // 所有 cell 中最大的 toArea
         
-        int maxIndex; // 記錄目前 bucket 中“最大 index”的位置，以方便快速找到「gain 最大」的 cell。
+        int maxIndex; // 目前「最大的非空」gain index (-1 表示全空)，移除時會往下修正，永遠是精確值
         string name;  // 用來記錄是哪一個 partition
         double size;  // 此 bucket 中的所有 cell 大小總和
         int cnt;      // 目前這個 partition 包含了多少個 cell
     
     public:
-        // 建構子：給定 Pmax，就開好 2*Pmax+1 個桶
-        Bucket(string name, int Pmax) {
-            name = name;
-            bucketList.resize(2 * Pmax + 1);
-            maxIndex = 0;
+        // 建構子：給定 Pmax，就開好 2*Pmax+1 個 gain index；
+        // toArea[c] 是 cell c 從這一邊搬到另一邊後的面積 (只存參考，要比 Bucket 活得久)
+        Bucket(string name, int Pmax, const vector<double> &toArea) : toArea(&toArea) {
+            this->name = name;
+            int numCells = toArea.size();
+            listHead.assign(2 * Pmax + 1, -1);
+            node.assign(numCells, Node{-1, -1, 0});
+            clock = 0;
+            indexed = false;
+            numClasses = 0;
+            exactClasses = false;
+            maxToArea = 0;
+            for (double a : toArea)
+                maxToArea = max(maxToArea, a);
+            maxIndex = -1;
             cnt = 0;
             size = 0;
         }
-    
-        
+
+        // 清空所有 gain bucket (不動 size / cnt)
+        void clearList() {
+            fill(listHead.begin(), listHead.end(), -1);
+            indexed = false;
+            maxIndex = -1;
+        }
+
+        // 把 cell c 放到 gain index i 的串列開頭
+        void insert(int c, int i) {
+            PROFILE_COUNT(bucketInserts, 1);
+            Node &n = node[c];
+            n.prev = -1;
+            n.next = listHead[i];
+            n.stamp = ++clock;
+            if (listHead[i] != -1)
+                node[listHead[i]].prev = c;
+            listHead[i] = c;
+            if (indexed)
+                insertClass(c, i);
+            if (i > maxIndex)
+                maxIndex = i;
+        }
+
+        // 把 cell c 從 gain index i 的串列移除
+        void remove(int c, int i) {
+            PROFILE_COUNT(bucketRemoves, 1);
+            const Node &n = node[c];
+            if (n.prev != -1)
+                node[n.prev].next = n.next;
+            else
+                listHead[i] = n.next;
+            if (n.next != -1)
+                node[n.next].prev = n.prev;
+            if (indexed)
+                removeClass(c, i);
+            // 最大的 bucket 被清空時，往下找到下一個非空的 bucket
+            while (maxIndex >= 0 && listHead[maxIndex] == -1)
+                --maxIndex;
+        }
+
+        // 依目前的 gain 串列建立面積索引 (每個類別串列內的順序與 gain 串列相同)
+        void buildIndex() {
+            if (numClasses == 0)
+                buildClasses();
+            head.assign(listHead.size() * numClasses, -1);
+            classMask.assign(listHead.size(), 0);
+            for (int i = 0; i <= maxIndex; ++i) {
+                int tail = -1;
+                for (int c = listHead[i]; c != -1; c = node[c].next)
+                    tail = c;
+                // 由尾到頭插到類別串列的開頭，順序就與 gain 串列相同
+                for (int c = tail; c != -1; c = node[c].prev)
+                    insertClass(c, i);
+            }
+            indexed = true;
+        }
+
+        // gain index i、面積類別 k 的串列開頭
+        int first(int i, int k) const { return head[i * numClasses + k]; }
+
+        // 在 gain index i 的串列中找第一顆 fits(toArea[c]) 的 cell (與逐一走訪串列的結果相同)，沒有就回傳 -1
+        // fits 對面積必須是單調的 (放得下的 cell 換成比較小的也放得下)
+        // 另一邊快滿時改用面積索引：類別串列也是後插入的在前面，每個類別裏第一顆可行的 cell 就是該類別的候選，
+        // 各類別的候選中 stamp 最大的就是 gain 串列上最前面的可行 cell
+        template <class Fits>
+        int firstFit(int i, Fits fits) {
+            if (listHead[i] == -1)
+                return -1;
+            const vector<double> &area = *toArea;
+            // 最大的 cell 也放得下 (大部分的時候)：串列的第一顆
+            if (fits(maxToArea))
+                return listHead[i];
+
+            if (!indexed) {
+                // 還沒建面積索引時先照串列找，連續 scanLimit 顆都放不下才建索引
+                int scanned = 0;
+                for (int c = listHead[i]; c != -1; c = node[c].next) {
+                    if (fits(area[c]))
+                        return c;
+                    if (++scanned == scanLimit)
+                        break;
+                }
+                if (scanned < scanLimit)
+                    return -1;
+                buildIndex();
+            }
+            // classUpper 遞增，整個類別都放得下的是前綴 [0, fit)
+            int fit = partition_point(classUpper.begin(), classUpper.end(), fits) - classUpper.begin();
+            unsigned long long mask = classMask[i];
+            int best = -1;
+            for (unsigned long long m = mask & ((1ULL << fit) - 1); m; m &= m - 1) {
+                int c = first(i, __builtin_ctzll(m));
+                if (best == -1 || node[c].stamp > node[best].stamp)
+                    best = c;
+            }
+            // 類別 fit 裏可能有部分 cell 放得下 (依分位數切的類別才會發生)，其後的類別都放不下
+            if (!exactClasses && fit < numClasses && (mask >> fit & 1))
+                for (int c = first(i, fit); c != -1; c = classNode[c].next)
+                    if (fits(area[c])) {
+                        if (best == -1 || node[c].stamp > node[best].stamp)
+                            best = c;
+                        break;
+                    }
+            return best;
+        }
+
+    private:
+        const vector<double> *toArea;
+
+        void insertClass(int c, int i) {
+            ClassNode &n = classNode[c];
+            int k = n.areaClass;
+            int &h = head[i * numClasses + k];
+            n.prev = -1;
+            n.next = h;
+            if (h != -1)
+                classNode[h].prev = c;
+            h = c;
+            classMask[i] |= 1ULL << k;
+        }
+
+        void removeClass(int c, int i) {
+            const ClassNode &n = classNode[c];
+            int k = n.areaClass;
+            int &h = head[i * numClasses + k];
+            if (n.prev != -1)
+                classNode[n.prev].next = n.next;
+            else
+                h = n.next;
+            if (n.next != -1)
+                classNode[n.next].prev = n.prev;
+            if (h == -1)
+                classMask[i] &= ~(1ULL << k);
+        }
+
+        // 類別的邊界由 toArea 的樣本 (最多約 1024 個) 決定，不用排序全部的 cell：
+        // 樣本中不同的 toArea 不超過 maxClasses 種時 (flat netlist 只有幾十種 lib cell)，一種面積一個類別；
+        // 否則 (例如 multilevel 的 cluster) 依樣本的分位數切成 maxClasses 段
+        void buildClasses() {
+            const vector<double> &area = *toArea;
+            size_t n = area.size();
+            size_t stride = max<size_t>(1, n / 1024);
+            vector<double> sample;
+            for (size_t c = 0; c < n; c += stride)
+                sample.push_back(area[c]);
+            sort(sample.begin(), sample.end());
+            vector<double> distinct(sample);
+            distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+
+            classUpper.clear();
+            exactClasses = (int)distinct.size() <= maxClasses;
+            if (exactClasses)
+                classUpper = distinct;
+            else {
+                for (int k = 1; k <= maxClasses; ++k) {
+                    double u = sample[(size_t)k * sample.size() / maxClasses - 1];
+                    if (classUpper.empty() || u > classUpper.back())
+                        classUpper.push_back(u);
+                }
+            }
+            // 最後一個類別要涵蓋所有 cell
+            if (classUpper.empty() || classUpper.back() < maxToArea) {
+                if (exactClasses && (int)classUpper.size() < maxClasses)
+                    classUpper.push_back(maxToArea);
+                else {
+                    exactClasses = false;
+                    if (classUpper.empty())
+                        classUpper.push_back(maxToArea);
+                    classUpper.back() = maxToArea;
+                }
+            }
+            numClasses = classUpper.size();
+
+            // 樣本沒抽到的面積會落在比它大的類別，這時類別就不是單一面積
+            classNode.assign(n, ClassNode{-1, -1, 0});
+            for (size_t c = 0; c < n; ++c) {
+                int k = lower_bound(classUpper.begin(), classUpper.end(), area[c]) - classUpper.begin();
+                classNode[c].areaClass = k;
+                if (classUpper[k] != area[c])
+                    exactClasses = false;
+            }
+        }
 };
 
 #endif // LIB_H
\ No newline at end of file
@@ -1,751 +1,556 @@
 #include <bits/stdc++.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
 #include "lib.h"  
+#include "hypergraph.h"
+#include "parser.h"
+#include "fm.h"
+#include "multilevel.h"
+#include "multistart.h"
+#include "kway.h"
+#include "verify.h"
+#include "eco.h"
+#include "labelprop.h"
+#include "cache.h"
 using namespace std;
 
-// /******************************************************
-//   預先計算 Cell 在 DieA/DieB 時的面積
-// ******************************************************/
-void computeCellAreas(map<string, Cell*> &cellMap, map<string, vector<LibraryCell>> &techLibCells, Die &dieA, Die &dieB){
-    // dieA.techName 例如 "TA"
-    // 在 techLibCells["TA"] 裏面找對應的 library cell
-    // 假設每顆 Cell 都會 match 一個 library cellName
-    // 找到後 areaA = width * height (for TA)
-    // dieB 同理
-    for(auto & kv : cellMap){
-        Cell* c = kv.second;
-        // 找出在 dieA.techName 之下, libCellName = c->libCellName 對應的寬高
-        // 這裡簡單線性搜尋, 亦可用 map 做加速
-        double wA = 0, hA = 0;
-        for(const auto &libC : techLibCells[dieA.techName]){
-            if(libC.name == c->libCellName){
-                wA = libC.width;
-                hA = libC.height;
-                break;
-            }
-        }
-        c->areaA = wA * hA;
-
-        double wB = 0, hB = 0;
-        for(const auto &libC : techLibCells[dieB.techName]){
-            if(libC.name == c->libCellName){
-                wB = libC.width;
-                hB = libC.height;
-                break;
-            }
-        }
-        c->areaB = wB * hB;
-    }
-}
-
-
-
-Cell* cellSelect(vector<Bucket> &buckets, double maxAreaA, double maxAreaB) {
-    int indexA = buckets[0].maxIndex;
-    int indexB = buckets[1].maxIndex;
-    bool tie = false;
-    list<Cell*>::iterator it;
-    
-    // 當至少有一邊還有候選的 bucket 時
-    while (indexA >= 0 || indexB >= 0) {    
-        tie = false;
-        // 若兩邊最高 gain 的 bucket 索引相同，則以目前總面積較大的 partition 為優先
-        if (indexA == indexB && buckets[0].size >= buckets[1].size)
-            tie = true;
-        
-        if (indexA > indexB || tie) {
-            // 從 A partition (buckets[0]) 的 bucketList 中選取候選 Cell
-            for (it = buckets[0].bucketList[indexA].begin(); it != buckets[0].bucketList[indexA].end(); ++it) {
-                // 模擬將此 Cell 從 A 移到 B 後的面積更新
-                double newAreaA = buckets[0].size - (*it)->areaA;
-                double newAreaB = buckets[1].size + (*it)->areaB;
-                // 檢查更新後兩邊是否都未超過各自的最大允許面積
-                if (newAreaA <= maxAreaA && newAreaB <= maxAreaB) {
-                    Cell* target = *it;
-                    it = buckets[0].bucketList[indexA].erase(it);
-                    return target;
-                }    
-            }
-            --indexA; // 當前 bucket 中沒有合適的候選，降低 gain 索引再試
-        }
-        else {
-            // 從 B partition (buckets[1]) 的 bucketList 中選取候選 Cell
-            for (it = buckets[1].bucketList[indexB].begin(); it != buckets[1].bucketList[indexB].end(); ++it) {
-                double newAreaB = buckets[1].size - (*it)->areaB;
-                double newAreaA = buckets[0].size + (*it)->areaA;
-                if (newAreaA <= maxAreaA && newAreaB <= maxAreaB) {
-                    Cell* target = *it;
-                    it = buckets[1].bucketList[indexB].erase(it);
-                    return target;
-                }    
-            }
-            --indexB;
-        }
+/******************************************************
+  預先計算 Cell 在每個 Die 時的面積 (areas[d][c]: cell c 放在 dies[d])
+  每個 die 先建一張 lib cell ID -> 面積的表，
+  之後每顆 cell 只要查一次表 (不再線性搜尋 LibCell 名稱)
+  某個 tech 沒有定義的 lib cell 面積為 0
+******************************************************/
+void computeCellAreas(const vector<Cell> &cells, int numLibCells, map<string, vector<LibraryCell>> &techLibCells,
+                      const vector<Die> &dies, vector<vector<double>> &areas)
+{
+    PROFILE_SCOPE(PhaseCellAreas);
+    areas.resize(dies.size());
+    vector<double> libArea(numLibCells);
+    for (size_t d = 0; d < dies.size(); ++d) {
+        fill(libArea.begin(), libArea.end(), 0.0);
+        for (const LibraryCell &libC : techLibCells[dies[d].techName])
+            libArea[libC.id] = libC.width * libC.height;
+
+        areas[d].resize(cells.size());
+        for (const Cell &c : cells)
+            areas[d][c.id] = libArea[c.libCellId];
     }
-    return NULL; // 若無任何 Cell 符合條件則回傳 NULL
 }
 
 
 
-
-
-void initGainAndBuckets(vector<Net> &nets, map<string, Cell*> &cellMap, vector<Bucket> &buckets,int &cutSize, int &Pmax)
+// 把組好的整個輸出檔用 write 寫出
+void writeBuffer(const string &filename, const string &buf)
 {
-    //init gain
-    for (auto &n : nets) {
-        string cellA, cellB; //the critical cell
-        for (auto &c : n.cells) {
-            if (!cellMap[c]->partition) {
-                ++n.cntBucket[0];
-                cellA = c;
-            }
-            else {
-                ++n.cntBucket[1];
-                cellB = c;
-            }
-        }
-        
-        // 先把 bool 狀態弄出來，使條件判斷更直覺
-        bool isCut = (n.cntBucket[0] > 0 && n.cntBucket[1] > 0);
-        bool allInA = (n.cntBucket[0] == n.cells.size());
-        bool allInB = (n.cntBucket[1] == n.cells.size());
-
-        // 1) 被切割 (isCut)
-        if (isCut) {
-            cutSize += n.weight; // 只要 A,B 都有 Cell，就算被切割
-
-            // 如果 A 邊只有 1 顆 Cell，且 B 邊還有 Cell，代表那顆 A Cell 是「critical」
-            if (n.cntBucket[0] == 1 && n.cntBucket[1] > 0) {
-                // cellA 為那唯一 A 邊 cell
-                cellMap[cellA]->gain += n.weight;
-            }
-            // 如果 B 邊只有 1 顆 Cell，且 A 邊還有 Cell，代表那顆 B Cell 是「critical」
-            if (n.cntBucket[1] == 1 && n.cntBucket[0] > 0) {
-                // cellB 為那唯一 B 邊 cell
-                cellMap[cellB]->gain += n.weight;
-            }
-        }
-        // 2) 未被切割 (uncut) -> 全部都在 A 或全部都在 B
-        else {
-            // 如果全部都在 A，且 A 邊 Cell 數 > 1
-            if (allInA && n.cntBucket[0] > 1) {
-                // 任意搬走一顆都會導致被切割 => 對整個 net 的所有 Cell 做 gain--
-                for (auto &c : n.cells) {
-                    cellMap[c]->gain -= n.weight;
-                }
-            }
-            // 如果全部都在 B，且 B 邊 Cell 數 > 1
-            else if (allInB && n.cntBucket[1] > 1) {
-                for (auto &c : n.cells) {
-                    cellMap[c]->gain -= n.weight;
-                }
-            }
-        }
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        cerr << "Cannot open output file: " << filename << endl;
+        return;
     }
-
-    //init buckets
-    for (auto &c : cellMap) {
-        int i = c.second->gain + Pmax;
-        if (!c.second->partition) {
-            if (i > buckets[0].maxIndex)
-                buckets[0].maxIndex = i;
-            buckets[0].bucketList[i].push_front(c.second);
-            buckets[0].bucketSet.insert(c.second->name);
-            c.second->it = buckets[0].bucketList[i].begin();
-        }
-        else {
-            if (i > buckets[1].maxIndex)
-                buckets[1].maxIndex = i;
-            buckets[1].bucketList[i].push_front(c.second);
-            buckets[1].bucketSet.insert(c.second->name);
-            c.second->it = buckets[1].bucketList[i].begin();
+    for (size_t done = 0; done < buf.size(); ) {
+        ssize_t r = write(fd, buf.data() + done, buf.size() - done);
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            cerr << "Cannot write output file: " << filename << endl;
+            break;
         }
+        done += r;
     }
-    return;
+    close(fd);
 }
 
-
-
 /******************************************************
-  初始化解（與先前類似，但要檢查面積限制）
-  這裡示範：先都放在 DieA，然後依序搬到 DieB，
-  直到不超過 DieB 利用率限制即可。
+  寫輸出檔
+  partition 先壓成 bit vector，各 die 的 cell 以 word 為單位依 ID 順序取出
+  (cell ID 依名稱排序指定，所以輸出也依名稱排序，結果穩定)
+  整個檔案先組在一塊預先算好大小的 buffer 裏，再用 write 一次寫出
 ******************************************************/
-void initSolution(vector<Bucket> &buckets, map<string, Cell*> &cellMap, Die &dieA, Die &dieB){
-    // 全部先放在 DieA
-    double usedAreaA = 0.0;
-    double usedAreaB = 0.0;
-    buckets[0].cnt = 0;
-    buckets[0].size = 0;
-    buckets[1].cnt = 0;
-    buckets[1].size = 0;
-
-    for(auto &kv : cellMap){
-        Cell* c = kv.second;
-        c->partition = false; // false => DieA
-        usedAreaA += c->areaA;
-        buckets[0].cnt++;
-        buckets[0].size += c->areaA;
-    }
-
-    // 如果 DieA 的面積超標，搬移部分 cell 到 DieB
-    if(usedAreaA > dieA.maxUsableArea()){
-        // 將 cell 按 (areaA - areaB) 從大到小排序
-        vector<Cell*> allCells;
-        for(auto &kv : cellMap){
-            allCells.push_back(kv.second);
-        }
-        sort(allCells.begin(), allCells.end(), 
-             [](Cell* a, Cell* b){ return (a->areaA - a->areaB) > (b->areaA - b->areaB); });
-
-        // 遍歷這些 cell，嘗試搬移直到 DieA 的面積滿足限制
-        for(auto &c : allCells){
-            if(usedAreaA <= dieA.maxUsableArea())
-                break;
-            // 檢查如果把此 cell 搬到 DieB，
-            // DieB 的面積不會超過限制，同時減少 DieA 的面積
-            if((usedAreaB + c->areaB) <= dieB.maxUsableArea()){
-                // 搬移 cell：從 DieA 到 DieB
-                c->partition = true;
-                usedAreaA -= c->areaA;
-                usedAreaB += c->areaB;
-                buckets[0].cnt--;
-                buckets[0].size -= c->areaA;
-                buckets[1].cnt++;
-                buckets[1].size += c->areaB;
+void writeOutput(const string &filename, int minCutSize, const Hypergraph &hg, const vector<Die> &dies,
+                 const vector<char> &partition) {
+    PROFILE_SCOPE(PhaseOutput);
+    int n = hg.numCells;
+    int numWords = (n + 63) / 64;
+    vector<uint64_t> inB(numWords, 0);
+    for (int c = 0; c < n; ++c)
+        inB[c >> 6] |= (uint64_t)(partition[c] & 1) << (c & 63);
+
+    int cntB = 0;
+    size_t nameBytes = 0;
+    for (int w = 0; w < numWords; ++w)
+        cntB += __builtin_popcountll(inB[w]);
+    for (int c = 0; c < n; ++c)
+        nameBytes += hg.cellNames[c].size() + 1;
+
+    string header[3] = {
+        "CutSize " + to_string(minCutSize) + "\n",
+        dies[0].name + " " + to_string(n - cntB) + "\n",
+        dies[1].name + " " + to_string(cntB) + "\n"
+    };
+    string buf;
+    buf.reserve(header[0].size() + header[1].size() + header[2].size() + nameBytes);
+    buf += header[0];
+
+    // side = 0 => DieA，side = 1 => DieB
+    for (int side = 0; side < 2; ++side) {
+        buf += header[1 + side];
+        for (int w = 0; w < numWords; ++w) {
+            uint64_t bits = side ? inB[w] : ~inB[w];
+            if (w == numWords - 1 && (n & 63))
+                bits &= (1ULL << (n & 63)) - 1;
+            for (; bits; bits &= bits - 1) {
+                string_view name = hg.cellNames[w * 64 + __builtin_ctzll(bits)];
+                buf.append(name.data(), name.size());
+                buf += '\n';
             }
         }
     }
+    writeBuffer(filename, buf);
 }
 
-
-
-void updatePartition(Cell* target, vector<Bucket> &buckets, bool from, int &cutSize)
+// 多層堆疊的輸出檔："CutSize <cut>"，接著每個 die 依序 "<dieName> <cell 數>" 與 cell 名稱 (依 ID 順序)
+void writeKWayOutput(const string &filename, int minCutSize, const Hypergraph &hg,
+                     const vector<Die> &dies, const vector<int> &partition)
 {
-    target->partition = !from;
-    target->lock = 1;
-    cutSize -= target->gain;
-    --buckets[from].cnt;
-    ++buckets[!from].cnt;
-
-    if(!from){ // from 是 A
-        buckets[from].size -= target->areaA;
-        buckets[!from].size += target->areaB;
-    }else{ // from 是 B
-        buckets[from].size -= target->areaB;
-        buckets[!from].size += target->areaA;
+    PROFILE_SCOPE(PhaseOutput);
+    int K = dies.size();
+    vector<int> start(K + 1, 0);
+    size_t bytes = 0;
+    for (int c = 0; c < hg.numCells; ++c) {
+        ++start[partition[c] + 1];
+        bytes += hg.cellNames[c].size() + 1;
     }
-    
-    return;
-}
-
-
-
-
-void updateBucketList(Cell* ptr, vector<Bucket> &buckets, int change, int &Pmax)
-{
-    int i = ptr->gain + Pmax;
-    buckets[ptr->partition].bucketList[i].erase(ptr->it);
-    buckets[ptr->partition].bucketList[i+change].push_front(ptr);
-    ptr->it = buckets[ptr->partition].bucketList[i+change].begin();
-    if (i + change > buckets[ptr->partition].maxIndex)
-        buckets[ptr->partition].maxIndex = i + change;
-    return;
-}
-
-Cell* findCritical(Cell* target, Net &net, map<string, Cell*> &cellMap, bool partition)
-{
-    for (auto &c : net.cells) {
-        if (cellMap[c]->partition == partition)
-            if (cellMap[c] != target)
-                return cellMap[c];
+    for (int d = 0; d < K; ++d)
+        start[d + 1] += start[d];
+    // 依 die 分桶 (counting sort，同一個 die 內保持 ID 順序)
+    vector<int> order(hg.numCells);
+    vector<int> pos(start.begin(), start.end() - 1);
+    for (int c = 0; c < hg.numCells; ++c)
+        order[pos[partition[c]]++] = c;
+
+    string buf = "CutSize " + to_string(minCutSize) + "\n";
+    buf.reserve(buf.size() + bytes + K * 32);
+    for (int d = 0; d < K; ++d) {
+        buf += dies[d].name + " " + to_string(start[d + 1] - start[d]) + "\n";
+        for (int k = start[d]; k < start[d + 1]; ++k) {
+            string_view name = hg.cellNames[order[k]];
+            buf.append(name.data(), name.size());
+            buf += '\n';
+        }
     }
-    return NULL;
+    writeBuffer(filename, buf);
 }
 
 
-
-void updateGain(Cell* target, Net &net, map<string, Cell*> &cellMap, vector<Bucket> &buckets, bool from, int &Pmax)
+// 印出目前 partition 兩邊的 cell 數與面積
+void printPartition(const FM &fm)
 {
-    // check critical nets before the move
-    if (net.cntBucket[!from] == 0) {
-        for (auto &c : net.cells) {
-            if (!cellMap[c]->lock) {
-                updateBucketList(cellMap[c], buckets, net.weight, Pmax);
-                cellMap[c]->gain += net.weight;
-            }
+    int cntA = 0, cntB = 0;
+    double A = 0, B = 0;
+    for (int c = 0; c < fm.hg.numCells; ++c) {
+        if (!fm.partition[c]) {
+            ++cntA;
+            A += fm.areaA[c];
         }
-    }
-    else if (net.cntBucket[!from] == 1) {
-        Cell* critical = findCritical(target, net, cellMap, !from);
-        if (!critical->lock) {
-            updateBucketList(critical, buckets, -net.weight, Pmax);
-            critical->gain -= net.weight;
-        }
-    }
-    --net.cntBucket[from];
-    ++net.cntBucket[!from]; 
-    // check critical nets after the move
-    if (net.cntBucket[from] == 0) {
-        for (auto &c : net.cells) {
-            if (!cellMap[c]->lock) {
-                updateBucketList(cellMap[c], buckets, -net.weight, Pmax);
-                cellMap[c]->gain -= net.weight;
-            }                    
-        }
-    }
-    else if (net.cntBucket[from] == 1) {
-        Cell* critical = findCritical(target, net, cellMap, from);
-        if (!critical->lock) {
-            updateBucketList(critical, buckets, net.weight, Pmax);
-            critical->gain += net.weight;
+        else {
+            ++cntB;
+            B += fm.areaB[c];
         }
     }
-    return;
+    cout << "cntA, cntB: " << cntA << ", " << cntB << endl;
+    cout << "sizeA, sizeB: " << A << ", " << B << endl;
 }
 
 
-
-void updateBucketSet(vector<pair<string, bool> > &move, vector<Bucket> &buckets, int bestPass)
+// 留給寫檔的時間：寫檔實際上每顆 cell 不到 0.1us，這裡抓得很寬
+double writeReserve(int numCells)
 {
-    for (int i = 0; i < bestPass; ++i) {
-        buckets[move[i].second].bucketSet.erase(move[i].first);
-        buckets[!move[i].second].bucketSet.insert(move[i].first);
-    }
-    return;
+    return 0.1 + 1e-6 * numCells;
 }
 
 
-/******************************************************
-  讀取輸入檔並解析
-******************************************************/
-void parseInput(const string &inFile, map<string, vector<LibraryCell>> &techLibCells, map<string, Cell*> &cellMap, Die &dieA, Die &dieB, vector<Net> &nets) {
-    ifstream fin(inFile);
-    if(!fin) {
-        cerr << "Cannot open input file: " << inFile << endl;
-        exit(1);
+// --verify：增量維護的 cut 與重新計算的 cut 比對，不同時回傳 false
+bool verifyCutSize(const string &where, int cutSize, int recomputed)
+{
+    if (cutSize == recomputed) {
+        cout << "verify (" << where << "): OK" << endl;
+        return true;
     }
+    cerr << "[Error] CutSize mismatch after " << where << ": incremental " << cutSize
+         << ", recomputed " << recomputed << endl;
+    return false;
+}
 
-    // 先定義一些變數，方便暫存
-    int numTechs = 0;   // 之後讀 "NumTechs"
-    int techLeft = -1;  // 還要解析幾組 "Tech"
-    
-    // 這兩個參數讀完之後，要再讀 nLib 行的 LibCell
-    int nLibLeft = 0;   // 目前這個技術還要讀多少行 LibCell
-    
-    int numCells = 0;   // "NumCells"
-    int cellsLeft = 0;  // 還要讀幾行 "Cell"
-    
-    int numNets = 0;    // "NumNets"
-    int netsLeft = 0;   // 還要讀幾組 Net
-    int netCellCount = 0; // 該 net 還要讀多少行 "Cell"
-    string currentTechName; 
-
-    // 逐行讀
-    string line;
-    while(true) {
-        if(!getline(fin, line)) {
-            // EOF
-            break;
-        }
-        // 跳過空白行
-        if(line.empty()) {
-            continue;
-        }
-        // 以 stringstream 切分
-        stringstream ss(line);
-        // 先讀第一個 token
-        string label;
-        ss >> label;
-        // 若 label 仍是空，跳過
-        if(label.empty()) {
-            continue;
-        }
-
-        // 核心: 判斷 label 是什麼
-        // 1) 若還在解析 "LibCell" 行
-        if(nLibLeft > 0) {
-            // 預期 line 是: "LibCell <libCellName> <w> <h>"
-            if(label != "LibCell") {
-                cerr << "[Error] Expect 'LibCell' but read: " << label << endl;
-                // 依需求要不要直接 exit
-                exit(1);
-            }
-            string libCellName;
-            double w, h;
-            ss >> libCellName >> w >> h;
-            // 放到上一個 tech
-            // 目前不知道哪個 tech? => 通常我們剛剛解析到 "Tech" 時就存起 techName
-            // 這裡可用某個暫存techName 來知道該放哪裡
-            // 這裡僅示意:
-            // 假設 parse "Tech ..." 時填了 currentTechName
-            techLibCells[currentTechName].emplace_back(libCellName, w, h);
-            
-
-            nLibLeft--;
-            // 若 nLibLeft == 0，代表該 tech 的 LibCell 都讀完了
-
-            continue; // 處理下一行
-        }
-
-        // 2) 若還在解析 "Cell" 行 (從 NumCells 開始)
-        if(cellsLeft > 0) {
-            // 預期: "Cell <CellName> <LibCellName>"
-            if(label != "Cell") {
-                cerr << "[Error] Expect 'Cell' but read: " << label << endl;
-                exit(1);
-            }
-            string cName, libName;
-            ss >> cName >> libName;
-            Cell* newC = new Cell(cName, libName);
-            cellMap[cName] = newC;
-
-            cellsLeft--;
-            continue;
-        }
-
-        // 3) 若正在解析某個 net 的 cell
-        if(netCellCount > 0) {
-            // 預期: "Cell <cellName>"
-            if(label != "Cell") {
-                cerr << "[Error] Expect 'Cell' but read: " << label << endl;
-                exit(1);
-            }
-            string tmpCell;
-            ss >> tmpCell;
-
-            // 讓 nets.back() 取得這個 cell
-            nets.back().cells.push_back(tmpCell);
-            cellMap[tmpCell]->nets.push_back(nets.back().name);
-            netCellCount--;
-
-            continue;
-        }
-
-        // 如果都不是前述狀態，那就看 label 為何:
-        if(label == "NumTechs") {
-            ss >> numTechs;
-            techLeft = numTechs; // 接下來會讀取 numTechs 組 Tech
-        }
-        else if(label == "Tech") {
-            // 格式: "Tech <techName> <nLib>"
-            string techName;
-            int nLib;
-            ss >> techName >> nLib;
-            // 把 techLeft-1
-            techLeft--;
-            // 記錄當前 techName
-            
-            currentTechName = techName;
-            // 之後要讀 nLib 行 "LibCell ..."
-            nLibLeft = nLib;  
-        }
-        else if(label == "DieSize") {
-            // 格式: "DieSize <width> <height>"
-            double w, h;
-            ss >> w >> h;
-            dieA.width = w;
-            dieA.height = h;
-            dieB.width = w;
-            dieB.height = h;
-        }
-        else if(label == "DieA") {
-            // 格式: "DieA <techA> <utilA>"
-            string techA;
-            double utilA;
-            ss >> techA >> utilA;
-            dieA = Die(techA, dieA.width, dieA.height, utilA);
-        }
-        else if(label == "DieB") {
-            // 同上
-            string techB;
-            double utilB;
-            ss >> techB >> utilB;
-            dieB = Die(techB, dieB.width, dieB.height, utilB);
-            // 假設 DieB 與 DieA 的寬高相同 (根據 spec)
-        }
-        else if(label == "NumCells") {
-            // 格式: "NumCells <n>"
-            ss >> numCells;
-            cellsLeft = numCells;
-        }
-        else if(label == "NumNets") {
-            // 格式: "NumNets <m>"
-            ss >> numNets;
-            netsLeft = numNets;
-        }
-        else if(label == "Net") {
-            // 格式: "Net <netName> <#Cells> <weight>"
-            string netName;
-            int cCount, weight;
-            ss >> netName >> cCount >> weight;
-            Net netObj(netName, weight);
-            nets.push_back(netObj);
-
-            // 之後要讀 cCount 行 "Cell <cellName>"
-            netCellCount = cCount;
-            netsLeft--;
-        }
-        else {
-            // 可能遇到不在規格中的行
-            // 可以自行決定要不要忽略或直接報錯
-            cerr << "[Warning] Unknown label: " << label << endl;
-        }
-    }
 
-    fin.close();
+// 到目前為止的最大 resident set size (KB)
+long peakRssKB()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
 }
 
 
-void writeOutput(const string &filename, int minCutSize, const vector<Bucket> &buckets) {
-    ofstream fout(filename);
-    if (!fout) {
-        cerr << "Cannot open output file: " << filename << endl;
+// --profile：寫出各階段時間與計數 (沒有用 -DHW2_PROFILE 編譯時只印警告)
+void reportProfile(const string &profileFile, const string &inFile, const Hypergraph &hg, double totalTime)
+{
+    if (profileFile.empty())
         return;
-    }
-    // 輸出 cut size
-    fout << "CutSize " << minCutSize << "\n";
-    
-    // 輸出 DieA 的結果 (假設 buckets[0] 為 DieA)
-    fout << "DieA " << buckets[0].bucketSet.size() << "\n";
-    for (const auto &cellName : buckets[0].bucketSet)
-        fout << cellName << "\n";
-    
-    
-    // 輸出 DieB 的結果 (假設 buckets[1] 為 DieB)
-    fout << "DieB " << buckets[1].bucketSet.size() << "\n";
-    for (const auto &cellName : buckets[1].bucketSet)
-        fout << cellName << "\n";
-    
-    fout.close();
+#ifdef HW2_PROFILE
+    writeProfile(profileFile, inFile, hg.numCells, hg.numNets, hg.netCells.size(), totalTime);
+#else
+    (void)inFile;
+    (void)hg;
+    (void)totalTime;
+    cerr << "[Warning] --profile needs a profiling build (make profile)" << endl;
+#endif
 }
 
 
-/** 
- * 在本回合所有移動 (passes) 結束後，
- * 我們已經呼叫  updateBucketSet(move, buckets, bestPass);
- * 使得 buckets[0]/buckets[1] 回到 bestPass 分割。
- * 
- * 這個函式會依照 buckets 裏的分割，重新掃一遍所有的 net，計算 cntBucket[0]/[1]，
- * 並且累計出真正對應這個「best partition」的 cutSize。
- * 
- * 最後把這個 cutSize 回傳給呼叫者 (或用參數傳回)。
- **/
-int recalcAfterBestPass(vector<Net> &nets,
-                        const map<string, Cell*> &cellMap,
-                        const vector<Bucket> &buckets)
+// early exit 的預設值：cell 數的 1%，但至少 500 步
+int defaultEarlyExit(int numCells)
 {
-    // 1) 先把所有 net 的 cntBucket 歸零
-    for (auto &net : nets) {
-        net.cntBucket[0] = 0;
-        net.cntBucket[1] = 0;
-    }
-
-    // 2) 掃描 buckets[0]/[1]，看有哪些 cell 屬於 partition A(=0), B(=1)
-    //    幫對應 net 的 cntBucket[x]++。
-    //    因為 buckets[0].bucketSet 全都是 partition=0 的 cell，
-    //    buckets[1].bucketSet 全都是 partition=1 的 cell。
-    for (auto &cellName : buckets[0].bucketSet) {
-        Cell* cptr = cellMap.at(cellName);
-        for (auto &netName : cptr->nets) {
-            // netName e.g. "N1", "N2"...
-            // 假設你是用 stoi( netName.substr(1) )-1 來當 index
-            // 也可用 map<string,int> 來對應 netName => net index
-            int idx = stoi(netName.substr(1)) - 1;
-            nets[idx].cntBucket[0]++;
-        }
-    }
-    for (auto &cellName : buckets[1].bucketSet) {
-        Cell* cptr = cellMap.at(cellName);
-        for (auto &netName : cptr->nets) {
-            int idx = stoi(netName.substr(1)) - 1;
-            nets[idx].cntBucket[1]++;
-        }
-    }
-
-    // 3) 計算 cutSize
-    int newCutSize = 0;
-    for (auto &net : nets) {
-        // 如果 net 的 cntBucket[0] > 0 且 cntBucket[1] > 0 => net 被切割 => 加 net.weight
-        if (net.cntBucket[0] > 0 && net.cntBucket[1] > 0) {
-            newCutSize += net.weight;
-        }
-    }
-
-    return newCutSize;
+    return max(500, numCells / 100);
 }
 
 
-
 /******************************************************
   主程式示例
 ******************************************************/
 int main(int argc, char *argv[]){
     if(argc < 3){
-        cerr << "Usage: " << argv[0] << " <input.txt> <output.out>\n";
+        cerr << "Usage: " << argv[0] << " <input.txt> <output.out> [--multilevel]"
+             << " [--multistart <N>] [--threads <T>] [--seed <S>] [--early-exit <K>]"
+             << " [--large-net <D>] [--time-limit <S>] [--verify] [--profile <json file>]"
+             << " [--warm-start <prev out>] [--eco <delta file>] [--eco-radius <R>] [--parallel-refine]"
+             << " [--cache <file>]\n";
         return 1;
     }
     string inFile = argv[1];
     string outFile = argv[2];
+    bool multilevel = false;  // --multilevel: 用 multilevel V-cycle 取代 flat FM
+    int numStarts = 1;        // --multistart: 跑幾組獨立的初始解
+    int numThreads = 0;       // --threads: 0 => 用全部的 hardware thread
+    bool threadsGiven = false;
+    unsigned seed = 1;        // --seed: 亂數種子，同樣的種子 (且全部組都跑完) 結果相同
+    int earlyExit = -1;       // --early-exit: 連續 K 步沒改善就結束 pass，0 => 關閉，-1 => 依 cell 數自動決定
+    int largeNetDegree = 0;   // --large-net: degree 超過 D 的 net 不維護 uncut 那一項 gain，0 => 關閉
+    double timeLimit = 170;   // --time-limit: 整個程式 (含讀寫檔) 的 wall-clock 秒數，預設 170s 避免超過三分鐘
+    bool verify = false;      // --verify: 每個 pass / V-cycle 後重新計算 cut 並與增量維護的值比對
+    string profileFile;       // --profile: 各階段時間與計數的 JSON ("-" => stdout)，只有 make profile 的版本有效
+    string warmStartFile;     // --warm-start: 上一次的輸出檔，當作 flat FM 的初始解
+    string ecoFile;           // --eco: ECO 變更檔 (要搭配 --warm-start)，只有變更附近的 cell 可以移動
+    int ecoRadius = 2;        // --eco-radius: 由變更的 cell 沿著 net 往外放開幾層
+    bool parallelRefine = false;  // --parallel-refine: FM 之前先用 --threads 個 thread 做 label propagation
+    string cacheFile;         // --cache: 解析結果的二進位 cache，有效就直接載入，否則解析後寫入
+    for (int i = 3; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--multilevel")
+            multilevel = true;
+        else if (arg == "--multistart" && i + 1 < argc)
+            numStarts = max(1, atoi(argv[++i]));
+        else if (arg == "--threads" && i + 1 < argc) {
+            numThreads = max(0, atoi(argv[++i]));
+            threadsGiven = true;
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (arg == "--early-exit" && i + 1 < argc)
+            earlyExit = max(0, atoi(argv[++i]));
+        else if (arg == "--large-net" && i + 1 < argc)
+            largeNetDegree = max(0, atoi(argv[++i]));
+        else if (arg == "--time-limit" && i + 1 < argc)
+            timeLimit = max(0.0, atof(argv[++i]));
+        else if (arg == "--verify")
+            verify = true;
+        else if (arg == "--profile" && i + 1 < argc)
+            profileFile = argv[++i];
+        else if (arg == "--warm-start" && i + 1 < argc)
+            warmStartFile = argv[++i];
+        else if (arg == "--eco" && i + 1 < argc)
+            ecoFile = argv[++i];
+        else if (arg == "--eco-radius" && i + 1 < argc)
+            ecoRadius = max(0, atoi(argv[++i]));
+        else if (arg == "--parallel-refine")
+            parallelRefine = true;
+        else if (arg == "--cache" && i + 1 < argc)
+            cacheFile = argv[++i];
+        else {
+            cerr << "Unknown option: " << arg << endl;
+            return 1;
+        }
+    }
+    if (!ecoFile.empty() && warmStartFile.empty()) {
+        cerr << "--eco needs --warm-start <previous output>" << endl;
+        return 1;
+    }
 
     map<string, vector<LibraryCell>> techLibCells; // techName -> list of LibCells
-    Die dieA, dieB;
-    map<string, Cell*> cellMap;     // cellName -> Cell*
-    vector<Net> nets;
+    vector<Die> dies;               // DieA / DieB，或多層堆疊時依序的各個 die
+    Hypergraph hg;                  // netlist 的 dense ID / CSR 表示
+    vector<Cell> cells;             // cell ID -> Cell
 
-    clock_t initTime = clock();
+    TimeBudget budget(timeLimit);   // 從這裡開始計時，讀檔也算在內
     /*-------Read File----------------------------------------------------------------------------------*/
-    parseInput(inFile, techLibCells, cellMap, dieA, dieB, nets);
+    Parser parser(inFile);          // cell / net 名稱都指向 parser 或 cache 的 mmap，要留到寫完輸出檔
+    NetlistCache cache;
+    int numLibCells = 0;
+    if (!cacheFile.empty() && cache.load(cacheFile, inFile, techLibCells, hg, cells, dies, numLibCells)) {
+        cout << "Load cache file " << cacheFile << endl;
+    }
+    else {
+        parser.parse(techLibCells, hg, cells, dies);
+        numLibCells = parser.numLibCells();
+        if (!cacheFile.empty() && NetlistCache::save(cacheFile, inFile, techLibCells, hg, cells, dies, numLibCells))
+            cout << "Write cache file " << cacheFile << endl;
+    }
+    // 至少有 DieA / DieB 兩個 die
+    if (dies.size() < 2)
+        dies.resize(2);
+    for (size_t d = 0; d < 2; ++d)
+        if (dies[d].name.empty())
+            dies[d].name = d ? "DieB" : "DieA";
 
-    cout << "Read input file done.\n";
+    cout << "Read input file done. (" << budget.elapsed() << " s)\n";
 
-    cout << "DieA: " << dieA.techName << ", width: " << dieA.width << ", height: " << dieA.height << ", utilization: " << dieA.util << endl;
-    cout << "DieB: " << dieB.techName << ", width: " << dieB.width << ", height: " << dieB.height << ", utilization: " << dieB.util << endl;
+    for (const Die &die : dies)
+        cout << die.name << ": " << die.techName << ", width: " << die.width << ", height: " << die.height << ", utilization: " << die.util << endl;
     for(auto & kv : techLibCells){
         cout << "Tech: " << kv.first  << ", libcell size:" << kv.second.size() << endl;
     }
     
-    cout << "NumCells: " << cellMap.size() << endl;
-    cout << "NumNets: " << nets.size() << endl;
+    cout << "NumCells: " << hg.numCells << endl;
+    cout << "NumNets: " << hg.numNets << endl;
 
     /*-------FM Algorithm----------------------------------------------------------------------------------*/
-    computeCellAreas(cellMap, techLibCells, dieA, dieB);
-
-    int Pmax = 0; 
-
-    // 走訪所有 Cell
-    for (auto &kv : cellMap) {
-        Cell* cellPtr = kv.second;  
-        int sumWeight = 0;
-
-        // 把該 Cell 連到的每條 net 的權重都加起來
-        for (auto &netName : cellPtr->nets) {
-            int i = stoi(netName.substr(1)) - 1;
-            sumWeight += nets[i].weight;
-        }
-
-        // 追蹤最大連接權重和
-        if (sumWeight > Pmax) {
-            Pmax = sumWeight;
-        }
+    vector<vector<double>> areas;   // areas[d][c]: cell c 放在 dies[d] 的面積
+    computeCellAreas(cells, numLibCells, techLibCells, dies, areas);
+
+    if (earlyExit < 0)
+        earlyExit = defaultEarlyExit(hg.numCells);
+    budget.reserve(writeReserve(hg.numCells));
+    // 一個 pass 的工作量 (見 TimeBudget)
+    double passWork = hg.numCells + (double)hg.netCells.size();
+    int iteration = 0;
+    int maxPartialSum = 0;
+    double itBegin, itTime, totalTime;
+
+    if (dies.size() > 2) {
+        // 多層堆疊：K 個 die 一次用 K-way FM 分割 (下面這些選項都只支援兩個 die)
+        string ignored;
+        if (multilevel)
+            ignored += " --multilevel";
+        if (numStarts > 1)
+            ignored += " --multistart";
+        if (threadsGiven)
+            ignored += " --threads";
+        if (parallelRefine)
+            ignored += " --parallel-refine";
+        if (!warmStartFile.empty())
+            ignored += " --warm-start";
+        if (!ecoFile.empty())
+            ignored += " --eco";
+        if (!ignored.empty())
+            cerr << "[Warning] ignored for more than two dies (cold K-way FM run):" << ignored << endl;
+        vector<double> maxArea;
+        for (const Die &die : dies)
+            maxArea.push_back(die.maxUsableArea());
+        KWayFM kfm(hg, areas, maxArea);
+        kfm.earlyExit = earlyExit;
+        kfm.largeNetDegree = largeNetDegree;
+        kfm.budget = &budget;
+        // 每顆 cell 在 K-1 個 bucket 裏，工作量以 cell 數 * K + pin 數計
+        passWork = hg.numCells * (double)dies.size() + hg.netCells.size();
+        cout << "NumDies: " << dies.size() << endl;
+        cout << "Pmax: " << kfm.Pmax << endl;
+        cout << "earlyExit: " << earlyExit << endl;
+        cout << "largeNetDegree: " << largeNetDegree << endl;
+        cout << "timeLimit: " << timeLimit << " (remaining " << budget.remaining() << ")" << endl << endl;
+
+        kfm.initSolution();
+        while (iteration == 0 || (maxPartialSum > 0 && budget.fits(passWork))) {
+            itBegin = budget.elapsed();
+            ++iteration;
+            maxPartialSum = kfm.runPass();
+            if (verify && !verifyCutSize("iteration " + to_string(iteration), kfm.cutSize,
+                                         computeKWayCutSize(hg, kfm.partition)))
+                return 1;
+
+            cout << "iteration " << iteration << endl;
+            cout << "--cutSize:  " << kfm.initCutSize << endl;
+            cout << "bestPass:  " << kfm.bestPass << endl;
+            cout << "--minCutSize:  " << kfm.cutSize << endl;
+            for (size_t d = 0; d < dies.size(); ++d)
+                cout << dies[d].name << " size: " << kfm.partSize[d] << " / " << maxArea[d] << endl;
+
+            totalTime = budget.elapsed();
+            itTime = totalTime - itBegin;
+            budget.record(passWork, itTime);
+            cout << "itTime: " << itTime << endl;
+            cout << "totalTime: " << totalTime << endl;
+            cout << "---------------------" << endl << endl;
+        }
+        writeKWayOutput(outFile, kfm.cutSize, hg, dies, kfm.partition);
+        cout << "Write output file done.\n";
+        cout << "Peak RSS: " << peakRssKB() << " KB" << endl;
+        reportProfile(profileFile, inFile, hg, budget.elapsed());
+        return 0;
     }
 
-    cout<< "Pmax: " << Pmax << endl << endl;
-
-    vector<Bucket> buckets = {  // 一邊一個 bucket
-        Bucket("A", Pmax),
-        Bucket("B", Pmax)
-    };
+    // 兩個 die：原本的 two-way FM
+    const Die &dieA = dies[0], &dieB = dies[1];
+    const vector<double> &areaA = areas[0], &areaB = areas[1];
+    FM fm(hg, areaA, areaB, dieA.maxUsableArea(), dieB.maxUsableArea());
+    fm.earlyExit = earlyExit;
+    fm.largeNetDegree = largeNetDegree;
+    fm.budget = &budget;
+    cout<< "Pmax: " << fm.Pmax << endl;
+    cout<< "earlyExit: " << earlyExit << endl;
+    cout<< "largeNetDegree: " << largeNetDegree << endl;
+    cout<< "timeLimit: " << timeLimit << " (remaining " << budget.remaining() << ")" << endl << endl;
+
+    if (numThreads == 0)
+        numThreads = max(1u, thread::hardware_concurrency());
+    // 只有一組解時，多的 thread 拿來平行重建 gain
+    fm.numThreads = numThreads;
+
+    // ECO：從上一次的結果出發；有變更檔時只讓變更附近的 cell 移動，其餘固定
+    bool warmStart = !warmStartFile.empty();
+    bool ecoFixed = false;
+    if (warmStart) {
+        if (numStarts > 1 || multilevel)
+            cerr << "[Warning] --warm-start runs flat FM, --multilevel / --multistart are ignored" << endl;
+        numStarts = 1;
+        multilevel = false;
+        Eco eco(hg);
+        if (!eco.readPartition(warmStartFile, dies, areaA, areaB, dieA.maxUsableArea(), dieB.maxUsableArea()))
+            return 1;
+        fm.setPartition(eco.partition);
+        cout << "warm start: " << eco.numAdded << " added, " << eco.numRemoved << " removed cells" << endl;
+        if (!ecoFile.empty()) {
+            if (!eco.readDelta(ecoFile))
+                return 1;
+            if (eco.numUnknown)
+                cerr << "[Warning] " << eco.numUnknown << " names in the ECO file are not in the netlist" << endl;
+            fm.setFixed(eco.fixedCells(ecoRadius));
+            ecoFixed = true;
+            cout << "ECO: " << eco.numFree << " / " << hg.numCells << " cells free (radius " << ecoRadius << ")" << endl;
+        }
+        cout << "--initCutSize: " << fm.cutSize << endl << endl;
+    }
 
-    int iteration = 0 , minCutSize = 0, cutSize = 0;
-    int partialSum = 0, maxPartialSum = 0;
-    clock_t itBegin, itEnd;
-    double itTime, totalTime;
-    while (iteration == 0 || (maxPartialSum > 0 && totalTime + itTime < 170)) { // 170s 避免超過三分鐘, 因為還要讀寫檔
-        itBegin = clock();
-        ++iteration;
-        partialSum = 0;
-        maxPartialSum = 0;
-        if (iteration == 1)
-            initSolution(buckets, cellMap, dieA, dieB);
-        else {
-            cutSize = 0;
-            double sizeA = 0, sizeB = 0;
-            for (auto &c : buckets[0].bucketSet) {
-                sizeA += cellMap[c]->areaA;
-                cellMap[c]->partition = 0;
-            }
-            for (auto &c : buckets[1].bucketSet) {
-                sizeB += cellMap[c]->areaB;
-                cellMap[c]->partition = 1;
-            }
-            buckets[0].cnt = buckets[0].bucketSet.size();
-            buckets[0].size = sizeA;
-            buckets[1].cnt = buckets[1].bucketSet.size();
-            buckets[1].size = sizeB;
-            buckets[0].bucketSet.clear();
-            buckets[1].bucketSet.clear();
-            for (auto &n : nets) {
-                n.cntBucket[0] = 0;
-                n.cntBucket[1] = 0;
-                n.lock[0] = 0;
-                n.lock[1] = 0;
-            }
-            for (auto &c : cellMap) {
-                c.second->gain = 0;
-                c.second->lock = 0;
-            }
+    if (numStarts > 1) {
+        MultiStart ms(hg, areaA, areaB, dieA.maxUsableArea(), dieB.maxUsableArea(), multilevel);
+        ms.earlyExit = earlyExit;
+        ms.largeNetDegree = largeNetDegree;
+        ms.parallelRefine = parallelRefine;
+        ms.run(numStarts, numThreads, seed, budget);
+        if (verify && !verifyCutSize("multistart", ms.cutSize, computeCutSize(hg, ms.partition)))
+            return 1;
+        fm.setPartition(ms.partition);
+
+        cout << "multistart: " << ms.startsDone << " / " << numStarts << " starts, "
+             << numThreads << " threads, seed " << seed << endl;
+        cout << "bestStart: " << ms.bestStart << endl;
+        cout << "--minCutSize:  " << fm.cutSize << endl;
+        printPartition(fm);
+        cout << "---------------------" << endl << endl;
+    }
+    else if (multilevel) {
+        // 每個 V-cycle 都從目前的解出發，cut 沒有再變小就停
+        Multilevel ml(hg, areaA, areaB, dieA.maxUsableArea(), dieB.maxUsableArea(), seed);
+        ml.earlyExit = earlyExit;
+        ml.largeNetDegree = largeNetDegree;
+        ml.budget = &budget;
+        ml.numThreads = numThreads;
+        ml.parallelRefine = parallelRefine;
+        int prevCutSize = INT_MAX;
+        // 下一個 V-cycle 預估放不下就停 (V-cycle 的花費也以 passWork 為單位記錄)
+        while (iteration == 0 || (ml.cutSize < prevCutSize && budget.fits(passWork))) {
+            itBegin = budget.elapsed();
+            ++iteration;
+            prevCutSize = iteration == 1 ? INT_MAX : ml.cutSize;
+            ml.vcycle();
+            if (verify && !verifyCutSize("V-cycle " + to_string(iteration), ml.cutSize, computeCutSize(hg, ml.partition)))
+                return 1;
+            fm.setPartition(ml.partition);
+
+            cout << "V-cycle " << iteration << endl;
+            cout << "--minCutSize:  " << fm.cutSize << endl;
+            printPartition(fm);
+
+            totalTime = budget.elapsed();
+            itTime = totalTime - itBegin;
+            budget.record(passWork, itTime);
+            cout << "itTime: " << itTime << endl;
+            cout << "totalTime: " << totalTime << endl;
+            cout << "---------------------" << endl << endl;
         }
-
-        initGainAndBuckets(nets, cellMap, buckets, cutSize, Pmax);
-        cout << "iteration " << iteration << endl;
-        cout << "--------init---------" << endl;
-        cout << "--cutSize:  " << cutSize << endl;
-        cout << "cntA, cntB: " << buckets[0].cnt << ", " << buckets[1].cnt << endl;
-        cout << "sizeA, sizeB: " << buckets[0].size << ", " << buckets[1].size << endl << endl;
-
-        int pass = 0, bestPass = 0;
-        minCutSize = cutSize;
-        
-        vector<pair<string, bool> > move;
-        Cell* target = cellSelect(buckets, dieA.maxUsableArea(), dieB.maxUsableArea());
-        while (target) {
-            ++pass;
-            partialSum += target->gain;
-            bool from = target->partition;
-            move.push_back(make_pair(target->name, from));
-            updatePartition(target, buckets, from, cutSize);
-            if (minCutSize > cutSize) {
-                minCutSize = cutSize;
-                maxPartialSum = partialSum;
-                bestPass = pass;
-            }
-            for (auto &n : target->nets) {
-                int i = stoi(n.substr(1)) - 1;
-                if (!(nets[i].lock[0] && nets[i].lock[1]))
-                    updateGain(target, nets[i], cellMap, buckets, from, Pmax);
-                else {
-                    --nets[i].cntBucket[from];
-                    ++nets[i].cntBucket[!from];
-                }
-                nets[i].lock[!from] = 1;
-            }
-            target = cellSelect(buckets, dieA.maxUsableArea(), dieB.maxUsableArea());
+    }
+    else {
+        if (!warmStart)
+            fm.initSolution();
+        // 平行 label propagation 先把 cut 降下來，剩下的交給 FM (有固定的 cell 時不做)
+        if (parallelRefine && !ecoFixed) {
+            itBegin = budget.elapsed();
+            LabelPropagation lp(hg, areaA, areaB, dieA.maxUsableArea(), dieB.maxUsableArea());
+            lp.numThreads = numThreads;
+            lp.budget = &budget;
+            vector<char> part = fm.partition;
+            int cut = fm.cutSize;
+            lp.refine(part, cut);
+            fm.setPartition(part);
+            if (verify && !verifyCutSize("label propagation", cut, fm.cutSize))
+                return 1;
+            cout << "label propagation: " << lp.batches << " batches (" << lp.revertedBatches << " reverted), "
+                 << lp.moves << " moves, " << numThreads << " threads" << endl;
+            cout << "--minCutSize:  " << fm.cutSize << endl;
+            printPartition(fm);
+            cout << "itTime: " << budget.elapsed() - itBegin << endl;
+            cout << "---------------------" << endl << endl;
+        }
+        // 依量到的每單位工作秒數預估下一個 pass，放不下就停；真的超時 pass 也會在中途停下
+        while (iteration == 0 || (maxPartialSum > 0 && budget.fits(passWork))) {
+            itBegin = budget.elapsed();
+            ++iteration;
+
+            cout << "iteration " << iteration << endl;
+            cout << "--------init---------" << endl;
+            printPartition(fm);
+            maxPartialSum = fm.runPass();
+            if (verify && !verifyCutSize("iteration " + to_string(iteration), fm.cutSize, computeCutSize(hg, fm.partition)))
+                return 1;
+            cout << "--cutSize:  " << fm.initCutSize << endl << endl;
+
+            cout << "--------best---------" << endl;
+            cout << "bestPass:  " << fm.bestPass <<  endl;
+            cout << "maxPartialSum: " << maxPartialSum << endl;
+            cout << "--minCutSize:  " << fm.cutSize << endl;  // 這裡印的 就是「真正對應 bestPass」的cutSize
+            printPartition(fm);
+
+            totalTime = budget.elapsed();
+            itTime = totalTime - itBegin;
+            budget.record(passWork, itTime);
+            cout << "itTime: " << itTime << endl;
+            cout << "totalTime: " << totalTime << endl;
+            cout << "---------------------" << endl << endl;
+        }
+        // ECO 附近的 cell 不足以滿足面積限制 (例如新增了很多 cell)：放開所有 cell 再 refine
+        if (ecoFixed && !fm.isFeasible()) {
+            cout << "ECO region cannot meet the area limits, refining the whole design" << endl;
+            fm.setFixed(vector<char>());
+            fm.refine(INT_MAX);
+            if (verify && !verifyCutSize("ECO fallback", fm.cutSize, computeCutSize(hg, fm.partition)))
+                return 1;
+            cout << "--minCutSize:  " << fm.cutSize << endl;
+            printPartition(fm);
         }
-
-        updateBucketSet(move, buckets, bestPass);
-        // 接下來立刻做「真正對應 bestPass」的 net 統計 & cutSize 重算
-        int finalCutSize = recalcAfterBestPass(nets, cellMap, buckets);
-        // 把 minCutSize 改成這個回溯後的結果
-        minCutSize = finalCutSize;
-
-        // 重新計算 buckets[0]/buckets[1] 的總 area (A, B) 只是用來印出來
-        double A = 0, B = 0;
-        for (auto c : buckets[0].bucketSet) 
-            A += cellMap[c]->areaA;
-        for (auto c : buckets[1].bucketSet)
-            B += cellMap[c]->areaB;
-
-        cout << "--------best---------" << endl;
-        cout << "bestPass:  " << bestPass <<  endl;
-        cout << "maxPartialSum: " << maxPartialSum << endl;
-        cout << "--minCutSize:  " << minCutSize << endl;  // 這裡印的 就是「真正對應 bestPass」的cutSize
-        cout << "cntA, cntB: " << buckets[0].bucketSet.size() << " " << buckets[1].bucketSet.size() << endl;
-        cout << "sizeA, sizeB: " << A << " " << B << endl;
-
-        itEnd = clock();
-        itTime = ((double)(itEnd - itBegin)) / CLOCKS_PER_SEC;
-        totalTime = ((double)(itEnd - initTime)) / CLOCKS_PER_SEC;
-        cout << "itTime: " << itTime << endl;
-        cout << "totalTime: " << totalTime << endl;
-        cout << "---------------------" << endl << endl;
     }
 
     /*---------writefile------------------------------------------------------------------------------------*/
-    writeOutput(outFile, minCutSize, buckets);
+    writeOutput(outFile, fm.cutSize, hg, dies, fm.partition);
     cout << "Write output file done.\n";
-
-    /*--------------------------------------------------------------------------------------------*/
-    for (auto &c : cellMap)
-        delete c.second;
-    
+    cout << "Peak RSS: " << peakRssKB() << " KB" << endl;
+    reportProfile(profileFile, inFile, hg, budget.elapsed());
 }
@@ -0,0 +1,225 @@
+#include <bits/stdc++.h>
+#include "multilevel.h"
+#include "fm.h"
+#include "labelprop.h"
+#include "verify.h"
+using namespace std;
+
+Multilevel::Multilevel(const Hypergraph &hg, const vector<double> &areaA, const vector<double> &areaB,
+                       double maxAreaA, double maxAreaB, unsigned seed)
+    : cutSize(0), earlyExit(0), largeNetDegree(0), budget(NULL), numThreads(1), parallelRefine(false), hg(hg), areaA(areaA), areaB(areaB),
+      maxAreaA(maxAreaA), maxAreaB(maxAreaB), rng(seed), partitioned(false)
+{
+}
+
+
+
+/******************************************************
+  first-choice coarsening
+  依亂數順序走訪還沒被合併的 cell u，對每個相鄰的 v 算
+    rating(u, v) = sum_{net e 同時連到 u, v} w(e) / (|e| - 1)
+  把 u 併進 rating 最高、而且合併後面積不超過上限的 v 所在的 cluster
+  (v 可以已經在某個 cluster 裏)
+******************************************************/
+bool Multilevel::coarsen(Level &fine, CoarseGraph &coarse, const vector<char> *part)
+{
+    const Hypergraph &g = *fine.hg;
+    const vector<double> &fineA = *fine.areaA;
+    const vector<double> &fineB = *fine.areaB;
+    int n = g.numCells;
+    double limitA = maxClusterRatio * maxAreaA;
+    double limitB = maxClusterRatio * maxAreaB;
+
+    vector<int> &cluster = fine.parent;
+    cluster.assign(n, -1);
+    vector<double> &clusterA = coarse.areaA;
+    vector<double> &clusterB = coarse.areaB;
+    clusterA.clear();
+    clusterB.clear();
+
+    vector<int> order(n);
+    for (int c = 0; c < n; ++c)
+        order[c] = c;
+    shuffle(order.begin(), order.end(), rng);
+
+    vector<double> score(n, 0.0);
+    vector<int> mark(n, -1);
+    vector<int> touched;
+    int numClusters = 0;
+
+    for (int u : order) {
+        if (cluster[u] != -1)
+            continue;
+
+        touched.clear();
+        for (const int *e = g.cellNetBegin(u); e != g.cellNetEnd(u); ++e) {
+            int d = g.netDegree(*e);
+            if (d < 2 || d > maxRatingNetDegree)
+                continue;
+            double r = (double)g.netWeight[*e] / (d - 1);
+            for (const int *v = g.netCellBegin(*e); v != g.netCellEnd(*e); ++v) {
+                if (*v == u || (part && (*part)[*v] != (*part)[u]))
+                    continue;
+                if (mark[*v] != u) {
+                    mark[*v] = u;
+                    score[*v] = 0;
+                    touched.push_back(*v);
+                }
+                score[*v] += r;
+            }
+        }
+
+        int best = -1;
+        double bestScore = 0;
+        for (int v : touched) {
+            double a = cluster[v] == -1 ? fineA[v] : clusterA[cluster[v]];
+            double b = cluster[v] == -1 ? fineB[v] : clusterB[cluster[v]];
+            if (a + fineA[u] <= limitA && b + fineB[u] <= limitB && score[v] > bestScore) {
+                best = v;
+                bestScore = score[v];
+            }
+        }
+
+        if (best == -1) {
+            cluster[u] = numClusters++;
+            clusterA.push_back(fineA[u]);
+            clusterB.push_back(fineB[u]);
+        }
+        else if (cluster[best] == -1) {
+            cluster[u] = cluster[best] = numClusters++;
+            clusterA.push_back(fineA[u] + fineA[best]);
+            clusterB.push_back(fineB[u] + fineB[best]);
+        }
+        else {
+            cluster[u] = cluster[best];
+            clusterA[cluster[u]] += fineA[u];
+            clusterB[cluster[u]] += fineB[u];
+        }
+    }
+
+    if (numClusters > 0.9 * n)
+        return false;
+
+    // contraction: net 上的 cell 換成 cluster 並去掉重複，只剩一個 cluster 的 net 不可能被切，直接丟掉
+    Hypergraph &cg = coarse.hg;
+    cg.numCells = numClusters;
+    vector<int> seen(numClusters, -1);
+    for (int e = 0; e < g.numNets; ++e) {
+        size_t start = cg.netCells.size();
+        for (const int *v = g.netCellBegin(e); v != g.netCellEnd(e); ++v) {
+            int k = cluster[*v];
+            if (seen[k] != e) {
+                seen[k] = e;
+                cg.netCells.push_back(k);
+            }
+        }
+        if (cg.netCells.size() - start < 2) {
+            cg.netCells.resize(start);
+            continue;
+        }
+        cg.netWeight.push_back(g.netWeight[e]);
+        cg.netCellStart.push_back(cg.netCells.size());
+        ++cg.numNets;
+    }
+    cg.buildCellNets();
+    return true;
+}
+
+
+
+/******************************************************
+  最粗層的初始分割：第一組用原本的 greedy initSolution，
+  其餘用隨機解，各自 FM 到收斂，留下 cut 最小的可行解
+******************************************************/
+vector<char> Multilevel::initialPartition(const Level &coarsest)
+{
+    FM fm(*coarsest.hg, *coarsest.areaA, *coarsest.areaB, maxAreaA, maxAreaB);
+    fm.earlyExit = earlyExit;
+    fm.largeNetDegree = largeNetDegree;
+    fm.budget = budget;
+    vector<char> best;
+    int bestCut = INT_MAX;
+    bool bestFeasible = false;
+    for (int t = 0; t < initialTries; ++t) {
+        if (t == 0)
+            fm.initSolution();
+        else
+            fm.randomSolution(rng);
+        fm.refine(INT_MAX);
+        bool feasible = fm.isFeasible();
+        if ((feasible && !bestFeasible) || (feasible == bestFeasible && fm.cutSize < bestCut)) {
+            best = fm.partition;
+            bestCut = fm.cutSize;
+            bestFeasible = feasible;
+        }
+    }
+    return best;
+}
+
+
+
+int Multilevel::vcycle()
+{
+    deque<CoarseGraph> graphs;  // deque: push_back 不會讓前面層的參考失效
+    vector<Level> levels;
+    vector<vector<char> > parts;  // 只有在從既有 partition 出發時使用
+
+    Level top = {&hg, &areaA, &areaB, vector<int>()};
+    levels.push_back(top);
+    if (partitioned)
+        parts.push_back(partition);
+
+    // 1) coarsen
+    while (levels.back().hg->numCells > coarsenTo) {
+        graphs.emplace_back();
+        if (!coarsen(levels.back(), graphs.back(), partitioned ? &parts.back() : NULL)) {
+            graphs.pop_back();
+            break;
+        }
+        Level next = {&graphs.back().hg, &graphs.back().areaA, &graphs.back().areaB, vector<int>()};
+        if (partitioned) {
+            // 只合併同一邊的 cell，所以 cluster 的 partition 就是成員的 partition
+            const vector<int> &parent = levels.back().parent;
+            vector<char> coarsePart(next.hg->numCells, 0);
+            for (size_t v = 0; v < parent.size(); ++v)
+                coarsePart[parent[v]] = parts.back()[v];
+            parts.push_back(coarsePart);
+        }
+        levels.push_back(next);
+    }
+
+    // 2) 最粗層的分割
+    vector<char> part = partitioned ? parts.back() : initialPartition(levels.back());
+
+    // 3) uncoarsen + FM refine
+    for (int l = (int)levels.size() - 1; l >= 0; --l) {
+        if (l < (int)levels.size() - 1) {
+            const vector<int> &parent = levels[l].parent;
+            vector<char> finePart(parent.size());
+            for (size_t v = 0; v < parent.size(); ++v)
+                finePart[v] = part[parent[v]];
+            part.swap(finePart);
+        }
+        if (parallelRefine) {
+            LabelPropagation lp(*levels[l].hg, *levels[l].areaA, *levels[l].areaB, maxAreaA, maxAreaB);
+            lp.numThreads = numThreads;
+            lp.budget = budget;
+            int cut = computeCutSize(*levels[l].hg, part);
+            lp.refine(part, cut);
+        }
+        FM fm(*levels[l].hg, *levels[l].areaA, *levels[l].areaB, maxAreaA, maxAreaB);
+        fm.earlyExit = earlyExit;
+        fm.largeNetDegree = largeNetDegree;
+        fm.budget = budget;
+        fm.numThreads = numThreads;
+        fm.setPartition(part);
+        fm.refine(INT_MAX);
+        part = fm.partition;
+        if (l == 0)
+            cutSize = fm.cutSize;
+    }
+
+    partition = part;
+    partitioned = true;
+    return cutSize;
+}
@@ -0,0 +1,72 @@
+#ifndef MULTILEVEL_H
+#define MULTILEVEL_H
+
+#include <deque>
+#include <random>
+#include <vector>
+#include "hypergraph.h"
+#include "budget.h"
+
+using namespace std;
+
+/************************************
+ * Multilevel:
+ *   hMETIS 式的 V-cycle
+ *   1. coarsen: 以 first-choice (heavy-edge) matching 把 cell 併成 cluster，
+ *      cluster 在 DieA / DieB 的面積都不能超過 maxClusterRatio * 各 die 的可用面積
+ *   2. 在最粗的那層做初始分割 (greedy + 多組隨機解，各自跑 FM)
+ *   3. uncoarsen: 一層層投影回去，每層都用 FM refine
+ *   之後的 V-cycle 只合併同一邊的 cell，從目前的解再做一次粗化/細化
+ ************************************/
+class Multilevel {
+    public:
+        // 粗化到 cell 數 <= coarsenTo，或這一層縮小不到 10% 就停
+        static const int coarsenTo = 150;
+        // 計算 rating 時略過太大的 net (對 matching 幾乎沒有幫助又很花時間)
+        static const int maxRatingNetDegree = 64;
+        // 最粗層要試幾組初始解
+        static const int initialTries = 8;
+        static constexpr double maxClusterRatio = 0.02;
+
+        vector<char> partition;  // 原始 netlist 上的最終分割
+        int cutSize;
+        int earlyExit;           // 每一層 FM 的 early exit (見 FM::earlyExit)
+        int largeNetDegree;      // 每一層 FM 的大 net 門檻 (見 FM::largeNetDegree)
+        const TimeBudget *budget;  // 每一層 FM 的時間預算 (見 FM::budget)
+        int numThreads;          // 每一層 FM 重建 gain 與 label propagation 的 thread 數 (見 FM::numThreads)
+        bool parallelRefine;     // 每一層 FM 之前先做平行的 label propagation (見 LabelPropagation)
+
+    public:
+        Multilevel(const Hypergraph &hg, const vector<double> &areaA, const vector<double> &areaB,
+                   double maxAreaA, double maxAreaB, unsigned seed);
+
+        // 做一個 V-cycle；第一次從頭分割，之後都從目前的 partition 出發
+        // 回傳這次 V-cycle 之後的 cut
+        int vcycle();
+
+    private:
+        struct Level {
+            const Hypergraph *hg;
+            const vector<double> *areaA;
+            const vector<double> *areaB;
+            vector<int> parent;  // 這一層的 cell -> 下一層 (較粗) 的 cluster
+        };
+        struct CoarseGraph {
+            Hypergraph hg;
+            vector<double> areaA, areaB;
+        };
+
+        const Hypergraph &hg;
+        const vector<double> &areaA;
+        const vector<double> &areaB;
+        double maxAreaA, maxAreaB;
+        mt19937 rng;
+        bool partitioned;
+
+        // 把 fine 粗化成 coarse；part 不為 NULL 時只合併同一邊的 cell
+        // 縮小幅度不夠時回傳 false
+        bool coarsen(Level &fine, CoarseGraph &coarse, const vector<char> *part);
+        vector<char> initialPartition(const Level &coarsest);
+};
+
+#endif // MULTILEVEL_H
@@ -0,0 +1,105 @@
+#include <bits/stdc++.h>
+#include "multistart.h"
+#include "multilevel.h"
+#include "labelprop.h"
+#include "fm.h"
+using namespace std;
+
+MultiStart::MultiStart(const Hypergraph &hg, const vector<double> &areaA, const vector<double> &areaB,
+                       double maxAreaA, double maxAreaB, bool multilevel)
+    : cutSize(0), bestStart(-1), startsDone(0), earlyExit(0), largeNetDegree(0), parallelRefine(false),
+      hg(hg), areaA(areaA), areaB(areaB),
+      maxAreaA(maxAreaA), maxAreaB(maxAreaB), multilevel(multilevel),
+      bestKey(LLONG_MAX), nextStart(0), finished(0)
+{
+}
+
+// 高位元放「不可行」，接著是 cut，最低 32 位元放 start 編號：數值越小越好
+long long MultiStart::makeKey(bool feasible, int cut, int start)
+{
+    return ((long long)!feasible << 62) | ((long long)cut << 32) | (unsigned)start;
+}
+
+
+
+void MultiStart::work(Worker &worker, int numStarts, unsigned seed, const TimeBudget &budget)
+{
+    FM fm(hg, areaA, areaB, maxAreaA, maxAreaB);  // 每個 thread 自己的 buckets / net 計數
+    fm.earlyExit = earlyExit;
+    fm.largeNetDegree = largeNetDegree;
+    fm.budget = &budget;
+    worker.bestKey = LLONG_MAX;
+
+    while (true) {
+        // 第 0 組一定會跑 (時間不夠時 FM 會直接停在初始解)，確保至少有一個解
+        int start = nextStart.fetch_add(1);
+        if (start >= numStarts || (start > 0 && budget.expired()))
+            break;
+
+        seed_seq seq{seed, (unsigned)start};
+        mt19937 rng(seq);
+        if (multilevel) {
+            // 第 0 組與單獨跑 --multilevel 同一個種子，結果不會比單一組差
+            Multilevel ml(hg, areaA, areaB, maxAreaA, maxAreaB, start == 0 ? seed : (unsigned)rng());
+            ml.earlyExit = earlyExit;
+            ml.largeNetDegree = largeNetDegree;
+            ml.budget = &budget;
+            ml.parallelRefine = parallelRefine;
+            int prevCutSize = INT_MAX;
+            while (ml.vcycle() < prevCutSize && !budget.expired())
+                prevCutSize = ml.cutSize;
+            fm.setPartition(ml.partition);
+        }
+        else {
+            if (start == 0)
+                fm.initSolution();
+            else
+                fm.randomSolution(rng);
+            if (parallelRefine) {
+                LabelPropagation lp(hg, areaA, areaB, maxAreaA, maxAreaB);
+                lp.budget = &budget;
+                vector<char> part = fm.partition;
+                int cut = fm.cutSize;
+                lp.refine(part, cut);
+                fm.setPartition(part);
+            }
+            fm.refine(INT_MAX);
+        }
+        ++finished;
+
+        long long key = makeKey(fm.isFeasible(), fm.cutSize, start);
+        if (key < worker.bestKey) {
+            worker.bestKey = key;
+            worker.bestPartition = fm.partition;
+        }
+        // lock-free min 歸約
+        long long cur = bestKey.load();
+        while (key < cur && !bestKey.compare_exchange_weak(cur, key))
+            ;
+    }
+}
+
+
+
+void MultiStart::run(int numStarts, int numThreads, unsigned seed, const TimeBudget &budget)
+{
+    numThreads = max(1, min(numThreads, numStarts));
+
+    vector<Worker> workers(numThreads);
+    vector<thread> threads;
+    for (int t = 1; t < numThreads; ++t)
+        threads.emplace_back(&MultiStart::work, this, ref(workers[t]), numStarts, seed, cref(budget));
+    work(workers[0], numStarts, seed, budget);
+    for (auto &th : threads)
+        th.join();
+
+    startsDone = finished.load();
+    long long key = bestKey.load();
+    for (auto &w : workers) {
+        if (w.bestKey == key) {
+            partition.swap(w.bestPartition);
+            cutSize = (int)((key >> 32) & 0x3fffffff);
+            bestStart = (int)(key & 0xffffffff);
+        }
+    }
+}
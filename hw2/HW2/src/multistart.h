@@ -0,0 +1,57 @@
+#ifndef MULTISTART_H
+#define MULTISTART_H
+
+#include <atomic>
+#include <vector>
+#include "hypergraph.h"
+#include "budget.h"
+
+using namespace std;
+
+/************************************
+ * MultiStart:
+ *   用 numThreads 個 thread 跑 numStarts 組彼此獨立的 FM (或 multilevel)，
+ *   每個 thread 有自己的 FM (buckets、net 計數)，只共用唯讀的 Hypergraph 與面積
+ *   第 i 組的亂數種子由 (seed, i) 決定；第 0 組固定用 greedy initSolution (multilevel 時直接用 seed，同單獨跑 multilevel)
+ *   最佳解用 lock-free 的 atomic min 歸約 (key = 不可行旗標 | cut | start 編號)，
+ *   cut 相同時取編號小的，所以結果與 thread 數、排程無關
+ ************************************/
+class MultiStart {
+    public:
+        vector<char> partition;  // 最佳解
+        int cutSize;
+        int bestStart;           // 最佳解是第幾組
+        int startsDone;          // 實際跑完幾組 (時間不夠時會少於 numStarts)
+        int earlyExit;           // 每組 FM 的 early exit (見 FM::earlyExit)
+        int largeNetDegree;      // 每組 FM 的大 net 門檻 (見 FM::largeNetDegree)
+        bool parallelRefine;     // 每組 FM 之前先做 label propagation (見 LabelPropagation)；
+                                 // thread 已經分給各組，所以每組只用 1 個 thread，結果仍與排程無關
+
+    public:
+        MultiStart(const Hypergraph &hg, const vector<double> &areaA, const vector<double> &areaB,
+                   double maxAreaA, double maxAreaB, bool multilevel);
+
+        // budget 用完之後就不再開始新的一組，正在跑的那幾組也會在 pass 中途停下
+        void run(int numStarts, int numThreads, unsigned seed, const TimeBudget &budget);
+
+    private:
+        struct Worker {
+            long long bestKey;
+            vector<char> bestPartition;
+        };
+
+        const Hypergraph &hg;
+        const vector<double> &areaA;
+        const vector<double> &areaB;
+        double maxAreaA, maxAreaB;
+        bool multilevel;
+
+        atomic<long long> bestKey;
+        atomic<int> nextStart;
+        atomic<int> finished;
+
+        void work(Worker &worker, int numStarts, unsigned seed, const TimeBudget &budget);
+        static long long makeKey(bool feasible, int cut, int start);
+};
+
+#endif // MULTISTART_H
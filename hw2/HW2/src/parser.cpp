@@ -0,0 +1,307 @@
+#include <bits/stdc++.h>
+#include <charconv>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "parser.h"
+using namespace std;
+
+Parser::Parser(const string &inFile)
+    : data(NULL), size(0), cur(NULL), end(NULL), fileName(inFile), mask(0)
+{
+    int fd = open(inFile.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Cannot open input file: " << inFile << endl;
+        exit(1);
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        cerr << "Cannot stat input file: " << inFile << endl;
+        exit(1);
+    }
+    size = st.st_size;
+    // 空檔案不能 mmap，當成沒有任何 token
+    if (size > 0) {
+        void *p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            cerr << "Cannot mmap input file: " << inFile << endl;
+            exit(1);
+        }
+        madvise(p, size, MADV_SEQUENTIAL);
+        data = (const char *)p;
+    }
+    close(fd);
+    cur = data;
+    end = data + size;
+}
+
+Parser::~Parser()
+{
+    if (data)
+        munmap((void *)data, size);
+}
+
+
+
+void Parser::fail(const string &msg) const
+{
+    cerr << "[Error] " << fileName << ": " << msg << endl;
+    exit(1);
+}
+
+// 回傳下一個以空白分隔的 token，檔案結束時回傳空字串
+string_view Parser::nextToken()
+{
+    while (cur < end && (unsigned char)*cur <= ' ')
+        ++cur;
+    const char *begin = cur;
+    while (cur < end && (unsigned char)*cur > ' ')
+        ++cur;
+    return string_view(begin, cur - begin);
+}
+
+string_view Parser::expectToken(const char *label)
+{
+    string_view tok = nextToken();
+    if (tok != label)
+        fail(string("Expect '") + label + "' but read: " + string(tok));
+    return tok;
+}
+
+int Parser::nextInt()
+{
+    string_view tok = nextToken();
+    int v = 0;
+    from_chars_result r = from_chars(tok.data(), tok.data() + tok.size(), v);
+    if (tok.empty() || r.ec != errc() || r.ptr != tok.data() + tok.size())
+        fail("Expect an integer but read: " + string(tok));
+    return v;
+}
+
+double Parser::nextDouble()
+{
+    string_view tok = nextToken();
+    double v = 0;
+    from_chars_result r = from_chars(tok.data(), tok.data() + tok.size(), v);
+    if (tok.empty() || r.ec != errc() || r.ptr != tok.data() + tok.size())
+        fail("Expect a number but read: " + string(tok));
+    return v;
+}
+
+
+
+// FNV-1a
+size_t Parser::hashName(string_view name)
+{
+    uint64_t h = 1469598103934665603ULL;
+    for (char ch : name) {
+        h ^= (unsigned char)ch;
+        h *= 1099511628211ULL;
+    }
+    return (size_t)h;
+}
+
+// 同名的 LibCell 不論屬於哪個 tech 都給同一個 ID
+int Parser::internLibCell(string_view name)
+{
+    auto it = libCellIds.emplace(name, (int)libCellIds.size()).first;
+    return it->second;
+}
+
+/******************************************************
+  依 cell 名稱排序後指定 dense cell ID
+  讓 FM 走訪 cell 的順序與先前用 map<string, Cell*> 存放時一致，
+  結果 (含 tie-break) 可以重現
+  排序時先比名稱的前 8 個 byte (存在 key 裏)，相同才去讀 mmap 裏的整個名稱
+  同時建立名稱 -> ID 的 hash table，讀 net 時用
+******************************************************/
+void Parser::assignCellIds(Hypergraph &hg, vector<Cell> &cells)
+{
+    size_t n = cells.size();
+    vector<pair<uint64_t, int>> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        // big-endian，不足 8 個 byte 補 0：整數的大小順序就是字典序
+        uint64_t prefix = 0;
+        string_view name = cells[i].name;
+        for (size_t k = 0; k < 8; ++k)
+            prefix = prefix << 8 | (k < name.size() ? (unsigned char)name[k] : 0);
+        keys[i] = make_pair(prefix, (int)i);
+    }
+    sort(keys.begin(), keys.end(), [&cells](const pair<uint64_t, int> &a, const pair<uint64_t, int> &b) {
+        if (a.first != b.first)
+            return a.first < b.first;
+        return cells[a.second].name < cells[b.second].name;
+    });
+    vector<Cell> sorted;
+    sorted.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        sorted.push_back(cells[keys[i].second]);
+    cells.swap(sorted);
+    hg.cellNames.reserve(n);
+
+    size_t cap = 16;
+    while (cap < 2 * n)
+        cap <<= 1;
+    slot.assign(cap, CellSlot{NULL, 0, -1});
+    mask = cap - 1;
+
+    for (Cell &c : cells) {
+        c.id = hg.addCell(c.name);
+        size_t h = hashName(c.name);
+        if (findCell(c.name, h) != -1)
+            fail("Duplicate cell: " + string(c.name));
+        size_t i = h & mask;
+        while (slot[i].name)
+            i = (i + 1) & mask;
+        slot[i] = CellSlot{c.name.data(), (uint32_t)(h >> 32), c.id};
+    }
+}
+
+// h = hashName(name)
+int Parser::findCell(string_view name, size_t h) const
+{
+    if (slot.empty())
+        return -1;
+    uint32_t tag = h >> 32;
+    for (size_t i = h & mask; slot[i].name; i = (i + 1) & mask) {
+        const CellSlot &s = slot[i];
+        if (s.tag != tag || (size_t)(end - s.name) < name.size() || memcmp(s.name, name.data(), name.size()) != 0)
+            continue;
+        // 表中的名稱要剛好在這裡結束 (後面是空白或檔案結尾)
+        if (s.name + name.size() == end || (unsigned char)s.name[name.size()] <= ' ')
+            return s.id;
+    }
+    return -1;
+}
+
+
+
+/******************************************************
+  解析輸入檔
+  格式以 token 為單位：每個區塊的第一個 token 是 label，
+  Tech / NumCells / NumNets / Net 後面固定跟著指定數量的 LibCell / Cell 行
+  多層堆疊 (3D-IC) 用 "NumDies <k>" 加上 k 行 "Die <dieName> <techName> <util>" 取代 DieA / DieB
+******************************************************/
+void Parser::parse(map<string, vector<LibraryCell>> &techLibCells, Hypergraph &hg,
+                   vector<Cell> &cells, vector<Die> &dies)
+{
+    PROFILE_SCOPE(PhaseParse);
+    cur = data;
+    // DieSize 可能出現在 die 之前或之後，所有 die 的大小都相同
+    double dieWidth = 0, dieHeight = 0;
+    while (true) {
+        string_view label = nextToken();
+        if (label.empty())
+            break;
+
+        if (label == "NumTechs") {
+            // 格式: "NumTechs <n>"，之後每組 Tech 自己帶 LibCell 數量
+            nextInt();
+        }
+        else if (label == "Tech") {
+            // 格式: "Tech <techName> <nLib>"，接著 nLib 行 "LibCell <libCellName> <w> <h>"
+            string techName(nextToken());
+            int nLib = nextInt();
+            vector<LibraryCell> &libs = techLibCells[techName];
+            libs.reserve(libs.size() + nLib);
+            for (int i = 0; i < nLib; ++i) {
+                expectToken("LibCell");
+                string_view libCellName = nextToken();
+                double w = nextDouble();
+                double h = nextDouble();
+                libs.emplace_back(string(libCellName), internLibCell(libCellName), w, h);
+            }
+        }
+        else if (label == "DieSize") {
+            // 格式: "DieSize <width> <height>"，所有 die 都相同
+            dieWidth = nextDouble();
+            dieHeight = nextDouble();
+            for (Die &die : dies) {
+                die.width = dieWidth;
+                die.height = dieHeight;
+            }
+        }
+        else if (label == "DieA" || label == "DieB") {
+            // 格式: "DieA <techName> <util>"
+            size_t index = label == "DieA" ? 0 : 1;
+            if (dies.size() <= index)
+                dies.resize(index + 1);
+            string techName(nextToken());
+            double util = nextDouble();
+            dies[index] = Die(string(label), techName, dieWidth, dieHeight, util);
+        }
+        else if (label == "NumDies") {
+            // 格式: "NumDies <k>"，之後 k 行 "Die <dieName> <techName> <util>"
+            int numDies = nextInt();
+            dies.reserve(dies.size() + numDies);
+        }
+        else if (label == "Die") {
+            string name(nextToken());
+            string techName(nextToken());
+            double util = nextDouble();
+            dies.emplace_back(name, techName, dieWidth, dieHeight, util);
+        }
+        else if (label == "NumCells") {
+            // 格式: "NumCells <n>"，接著 n 行 "Cell <cellName> <libCellName>"
+            int numCells = nextInt();
+            cells.reserve(cells.size() + numCells);
+            for (int i = 0; i < numCells; ++i) {
+                expectToken("Cell");
+                string_view name = nextToken();
+                string_view libCellName = nextToken();
+                auto lib = libCellIds.find(libCellName);
+                if (lib == libCellIds.end())
+                    fail("Unknown lib cell of " + string(name) + ": " + string(libCellName));
+                // cell ID 等所有 cell 讀完後再依名稱指定
+                cells.emplace_back(-1, name, lib->second);
+            }
+        }
+        else if (label == "NumNets") {
+            // 格式: "NumNets <m>"，接著 m 組 "Net <netName> <#Cells> <weight>" + #Cells 行 "Cell <cellName>"
+            int numNets = nextInt();
+            // 所有 cell 都已讀完，在讀 net 之前先決定 cell ID
+            assignCellIds(hg, cells);
+            hg.netNames.reserve(numNets);
+            hg.netWeight.reserve(numNets);
+            hg.netCellStart.reserve(numNets + 1);
+            // 每個 pin 至少佔 "Cell x\n" 7 個 byte，剩下的檔案大小 / 7 是 pin 數的上界
+            hg.netCells.reserve((end - cur) / 7);
+            for (int e = 0; e < numNets; ++e) {
+                expectToken("Net");
+                string_view netName = nextToken();
+                int degree = nextInt();
+                int weight = nextInt();
+                hg.addNet(netName, weight);
+                // 先讀完整條 net 的名稱並 prefetch 對應的 hash table entry，再逐一查表，
+                // 讓同一條 net 的 cache miss 可以重疊
+                pinNames.clear();
+                pinHashes.clear();
+                for (int p = 0; p < degree; ++p) {
+                    expectToken("Cell");
+                    pinNames.push_back(nextToken());
+                    size_t h = hashName(pinNames.back());
+                    pinHashes.push_back(h);
+                    __builtin_prefetch(&slot[h & mask]);
+                }
+                for (int p = 0; p < degree; ++p) {
+                    int c = findCell(pinNames[p], pinHashes[p]);
+                    if (c < 0)
+                        fail("Unknown cell on net " + string(netName) + ": " + string(pinNames[p]));
+                    hg.addPin(c);
+                }
+            }
+        }
+        else {
+            // 不在規格中的 token，略過
+            cerr << "[Warning] Unknown label: " << label << endl;
+        }
+    }
+
+    // 所有 net 讀完，建立 cell -> nets 的 CSR
+    hg.buildCellNets();
+    // 查表只在解析時用到
+    vector<CellSlot>().swap(slot);
+    vector<string_view>().swap(pinNames);
+    vector<size_t>().swap(pinHashes);
+}
@@ -0,0 +1,73 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "lib.h"
+#include "hypergraph.h"
+
+using namespace std;
+
+/************************************
+ * Parser:
+ *   把輸入檔 mmap 進來，直接在檔案內容上切 token (不經過 getline / stringstream)
+ *   cell / net 名稱都是指向 mmap 區域的 string_view，不另外複製，
+ *   所以 Parser 必須比 Hypergraph、cells 活得久 (寫完輸出檔之後才能解構)
+ *   cell 與 pin 依 NumCells / NumNets 一次配置好連續的陣列，不再逐顆 new
+ ************************************/
+class Parser {
+    public:
+        explicit Parser(const string &inFile);  // 開檔或 mmap 失敗就 exit(1)
+        ~Parser();
+        Parser(const Parser &) = delete;
+        Parser &operator=(const Parser &) = delete;
+
+        // cells[c] 為 cell ID = c 的 Cell (ID 依名稱排序指定)
+        // dies 依輸入檔的順序：DieA / DieB 固定是 dies[0] / dies[1]，"Die <name> ..." 依序接在後面
+        void parse(map<string, vector<LibraryCell>> &techLibCells, Hypergraph &hg,
+                   vector<Cell> &cells, vector<Die> &dies);
+
+        size_t fileSize() const { return size; }
+        // 讀到的 lib cell 名稱數 (各 tech 的 LibCell 依名稱合併)，LibraryCell::id / Cell::libCellId < numLibCells()
+        int numLibCells() const { return (int)libCellIds.size(); }
+
+    private:
+        const char *data;
+        size_t size;
+        const char *cur;
+        const char *end;
+        string fileName;
+
+        // cell 名稱 -> cell ID 的 open addressing hash table
+        // 名稱、hash 的高 32 位元與 ID 放在同一個 16-byte entry，查詢時不必再去讀 cells (大 netlist 時少一次 cache miss)
+        // 名稱是 mmap 裏的 token，後面一定接著空白或檔案結尾，所以不用存長度
+        // 只在解析時使用，parse 結束就釋放
+        struct CellSlot {
+            const char *name;  // NULL 表示空
+            uint32_t tag;      // hash 的高 32 位元，不同時不用比對名稱
+            int id;
+        };
+        vector<CellSlot> slot;
+        size_t mask;
+        vector<string_view> pinNames;  // 一條 net 的 cell 名稱 (先讀完再一起查表)
+        vector<size_t> pinHashes;
+        // lib cell 名稱 -> lib cell ID (數量很少，直接用 unordered_map)
+        unordered_map<string_view, int> libCellIds;
+
+        string_view nextToken();
+        string_view expectToken(const char *label);
+        int nextInt();
+        double nextDouble();
+        void fail(const string &msg) const;
+
+        void assignCellIds(Hypergraph &hg, vector<Cell> &cells);
+        int findCell(string_view name, size_t h) const;
+        int internLibCell(string_view name);
+        static size_t hashName(string_view name);
+};
+
+#endif // PARSER_H
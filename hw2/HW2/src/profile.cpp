@@ -0,0 +1,181 @@
+#include <bits/stdc++.h>
+#include "profile.h"
+using namespace std;
+
+#ifdef HW2_PROFILE
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// 已結束 thread 的計數總和
+static Profile finished;
+static mutex finishedMutex;
+
+Profile::Profile()
+    : bucketInserts(0), bucketRemoves(0), selects(0), infeasibleSkips(0), moves(0)
+{
+    fill(seconds, seconds + NumProfilePhases, 0.0);
+    fill(calls, calls + NumProfilePhases, 0LL);
+    fill(netUpdates, netUpdates + numDegreeBins, 0LL);
+    fill(gainUpdates, gainUpdates + numDegreeBins, 0LL);
+}
+
+void Profile::merge(const Profile &other)
+{
+    for (int p = 0; p < NumProfilePhases; ++p) {
+        seconds[p] += other.seconds[p];
+        calls[p] += other.calls[p];
+    }
+    bucketInserts += other.bucketInserts;
+    bucketRemoves += other.bucketRemoves;
+    selects += other.selects;
+    infeasibleSkips += other.infeasibleSkips;
+    moves += other.moves;
+    for (int b = 0; b < numDegreeBins; ++b) {
+        netUpdates[b] += other.netUpdates[b];
+        gainUpdates[b] += other.gainUpdates[b];
+    }
+}
+
+ThreadProfile::~ThreadProfile()
+{
+    lock_guard<mutex> guard(finishedMutex);
+    finished.merge(profile);
+}
+
+
+
+/******************************************************
+  硬體計數器 (perf_event_open)：程式開始時打開，writeProfile 時讀出
+  只算 user space，inherit 讓之後建立的 thread (multistart) 也算進去
+  沒有 PMU 或權限不足 (容器、VM、perf_event_paranoid) 時打不開，JSON 裏寫 null
+******************************************************/
+class HardwareCounters {
+    public:
+        static const int numCounters = 3;
+
+        HardwareCounters() {
+            const unsigned long long cacheRead = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            fd[0] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            fd[1] = open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | cacheRead);
+            fd[2] = open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | cacheRead);
+        }
+        ~HardwareCounters() {
+            for (int i = 0; i < numCounters; ++i)
+                if (fd[i] != -1)
+                    close(fd[i]);
+        }
+        // 打不開或讀不到時回傳 -1
+        long long read(int i) const {
+            long long value;
+            if (fd[i] == -1 || ::read(fd[i], &value, sizeof(value)) != (ssize_t)sizeof(value))
+                return -1;
+            return value;
+        }
+
+    private:
+        int fd[numCounters];
+
+        static int open(unsigned type, unsigned long long config) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.inherit = 1;
+            return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+};
+
+static HardwareCounters hardwareCounters;
+
+
+
+/******************************************************
+  JSON 格式:
+  { "input", "numCells", "numNets", "numPins", "totalSeconds",
+    "phases": { "<phase>": { "seconds", "calls" }, ... },
+    "counters": { "bucketInserts", ... },
+    "gainUpdatesByDegree": [ { "minDegree", "maxDegree", "netUpdates", "gainUpdates" }, ... ],
+    "hardwareCounters": { "instructions", "l1dReadMisses", "llcReadMisses" } }
+  gainUpdatesByDegree 只列出有資料的 degree 區間
+  hardwareCounters 是整個程式 (含已結束的 thread) 的計數，量不到的項目是 null
+******************************************************/
+void writeProfile(const string &filename, const string &inFile, int numCells, int numNets,
+                  long long numPins, double totalSeconds)
+{
+    static const char *phaseNames[NumProfilePhases] = {
+        "parse", "computeCellAreas", "initGainAndBuckets", "selectMove", "recalcAfterBestPass", "labelPropagation", "output"
+    };
+
+    Profile total;
+    {
+        lock_guard<mutex> guard(finishedMutex);
+        total = finished;
+    }
+    total.merge(threadProfile());
+
+    ostringstream out;
+    out << setprecision(6) << fixed;
+    out << "{\n";
+    out << "  \"input\": \"" << inFile << "\",\n";
+    out << "  \"numCells\": " << numCells << ",\n";
+    out << "  \"numNets\": " << numNets << ",\n";
+    out << "  \"numPins\": " << numPins << ",\n";
+    out << "  \"totalSeconds\": " << totalSeconds << ",\n";
+    out << "  \"phases\": {\n";
+    for (int p = 0; p < NumProfilePhases; ++p)
+        out << "    \"" << phaseNames[p] << "\": { \"seconds\": " << total.seconds[p]
+            << ", \"calls\": " << total.calls[p] << " }" << (p + 1 < NumProfilePhases ? "," : "") << "\n";
+    out << "  },\n";
+    out << "  \"counters\": {\n";
+    out << "    \"bucketInserts\": " << total.bucketInserts << ",\n";
+    out << "    \"bucketRemoves\": " << total.bucketRemoves << ",\n";
+    out << "    \"selects\": " << total.selects << ",\n";
+    out << "    \"infeasibleSkips\": " << total.infeasibleSkips << ",\n";
+    out << "    \"moves\": " << total.moves << "\n";
+    out << "  },\n";
+    out << "  \"gainUpdatesByDegree\": [";
+    bool first = true;
+    for (int b = 0; b < Profile::numDegreeBins; ++b) {
+        if (!total.netUpdates[b] && !total.gainUpdates[b])
+            continue;
+        long long minDegree = b == 0 ? 1 : (1LL << (b - 1)) + 1;
+        long long maxDegree = 1LL << b;
+        out << (first ? "\n" : ",\n") << "    { \"minDegree\": " << minDegree << ", \"maxDegree\": " << maxDegree
+            << ", \"netUpdates\": " << total.netUpdates[b] << ", \"gainUpdates\": " << total.gainUpdates[b] << " }";
+        first = false;
+    }
+    out << (first ? "],\n" : "\n  ],\n");
+    static const char *counterNames[HardwareCounters::numCounters] = {
+        "instructions", "l1dReadMisses", "llcReadMisses"
+    };
+    out << "  \"hardwareCounters\": {\n";
+    for (int i = 0; i < HardwareCounters::numCounters; ++i) {
+        long long value = hardwareCounters.read(i);
+        out << "    \"" << counterNames[i] << "\": ";
+        if (value < 0)
+            out << "null";
+        else
+            out << value;
+        out << (i + 1 < HardwareCounters::numCounters ? "," : "") << "\n";
+    }
+    out << "  }\n";
+    out << "}\n";
+
+    if (filename == "-") {
+        cout << out.str();
+        return;
+    }
+    ofstream fout(filename);
+    if (!fout) {
+        cerr << "Cannot open profile file: " << filename << endl;
+        return;
+    }
+    fout << out.str();
+}
+
+#endif // HW2_PROFILE
@@ -0,0 +1,106 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/************************************
+ * Profile:
+ *   hot path 的分段計時與計數，預設不編譯進去 (make profile 會加上 -DHW2_PROFILE，產生 hw2_profile)
+ *   沒有定義 HW2_PROFILE 時所有 PROFILE_* 巨集都是空的 (參數也不會被求值)，一般版本的速度不受影響
+ *   每個 thread 各自累計 (multistart 的 worker 之間不用同步)，thread 結束時併入總計，
+ *   所以多 thread 時各階段的秒數是所有 thread 的加總
+ ************************************/
+#ifdef HW2_PROFILE
+
+#include <chrono>
+#include <string>
+
+using namespace std;
+
+enum ProfilePhase {
+    PhaseParse,               // Parser::parse
+    PhaseCellAreas,           // computeCellAreas
+    PhaseInitGain,            // 整個重建 gain 與 bucket (initGainAndBuckets)
+    PhaseSelectMove,          // pass 中 cellSelect + 搬移 + 更新 gain 的迴圈
+    PhaseRecalcAfterBestPass, // pass 結束後退回 bestPass 並修正 gain (rollback + prepareNextPass)
+    PhaseLabelPropagation,    // LabelPropagation::refine (--parallel-refine)
+    PhaseOutput,              // 寫輸出檔
+    NumProfilePhases
+};
+
+struct Profile {
+    // net degree 依 2 的次方分組：1, 2, 3-4, 5-8, ...
+    static const int numDegreeBins = 32;
+
+    double seconds[NumProfilePhases];
+    long long calls[NumProfilePhases];
+
+    long long bucketInserts;
+    long long bucketRemoves;
+    long long selects;          // cellSelect 呼叫次數
+    long long infeasibleSkips;  // cellSelect 因為非空的 gain 串列裏沒有放得下的 cell 而往下找的次數
+    long long moves;
+    long long netUpdates[numDegreeBins];   // 搬移時走訪到的 net (依 degree 分組)
+    long long gainUpdates[numDegreeBins];  // 因此改變的 cell gain 數
+
+    Profile();
+    void merge(const Profile &other);
+
+    static int degreeBin(int degree) {
+        return degree <= 1 ? 0 : 64 - __builtin_clzll((unsigned long long)degree - 1);
+    }
+};
+
+// thread 結束時把它的計數併入總計
+struct ThreadProfile {
+    Profile profile;
+    ~ThreadProfile();
+};
+
+// 目前 thread 的計數
+inline Profile &threadProfile()
+{
+    thread_local ThreadProfile p;
+    return p.profile;
+}
+
+// 把已結束的 thread 與目前 thread 的計數加總，寫成 JSON ("-" 表示 stdout)
+void writeProfile(const string &filename, const string &inFile, int numCells, int numNets,
+                  long long numPins, double totalSeconds);
+
+class ProfileTimer {
+    public:
+        explicit ProfileTimer(ProfilePhase phase) : phase(phase), begin(chrono::steady_clock::now()) {}
+        ~ProfileTimer() { add(phase, begin); }
+        // 把 begin 到現在的時間計入 phase
+        static void add(ProfilePhase phase, chrono::steady_clock::time_point begin) {
+            Profile &p = threadProfile();
+            p.seconds[phase] += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            ++p.calls[phase];
+        }
+    private:
+        ProfilePhase phase;
+        chrono::steady_clock::time_point begin;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+// 從這裡到所在 scope 結束的時間計入 phase
+#define PROFILE_SCOPE(phase) ProfileTimer PROFILE_CONCAT(profileTimer, __LINE__)(phase)
+// 不方便用 scope 的區段 (例如 pass 的主迴圈) 用 START / STOP 成對標記
+#define PROFILE_START(name) chrono::steady_clock::time_point name = chrono::steady_clock::now()
+#define PROFILE_STOP(name, phase) ProfileTimer::add(phase, name)
+#define PROFILE_COUNT(counter, n) (threadProfile().counter += (n))
+#define PROFILE_NET(degree) (++threadProfile().netUpdates[Profile::degreeBin(degree)])
+#define PROFILE_GAIN(degree, n) (threadProfile().gainUpdates[Profile::degreeBin(degree)] += (n))
+
+#else
+
+#define PROFILE_SCOPE(phase) ((void)0)
+#define PROFILE_START(name) ((void)0)
+#define PROFILE_STOP(name, phase) ((void)0)
+#define PROFILE_COUNT(counter, n) ((void)0)
+#define PROFILE_NET(degree) ((void)0)
+#define PROFILE_GAIN(degree, n) ((void)0)
+
+#endif // HW2_PROFILE
+
+#endif // PROFILE_H
@@ -0,0 +1,46 @@
+#include <bits/stdc++.h>
+#include "verify.h"
+using namespace std;
+
+int computeCutSize(const Hypergraph &hg, const vector<char> &partition)
+{
+    // 1) gather：pinSide[k] = 第 k 個 pin 所在的那一邊
+    size_t numPins = hg.netCells.size();
+    vector<unsigned char> pinSide(numPins);
+    const int *cells = hg.netCells.data();
+    for (size_t k = 0; k < numPins; ++k)
+        pinSide[k] = partition[cells[k]] & 1;
+
+    // 2) 每條 net 數在 DieB 的 pin，0 < ones < degree 就被切
+    const unsigned char *side = pinSide.data();
+    int cut = 0;
+    for (int e = 0; e < hg.numNets; ++e) {
+        int begin = hg.netCellStart[e], end = hg.netCellStart[e + 1];
+        int ones = 0;
+        for (int k = begin; k < end; ++k)
+            ones += side[k];
+        cut += (ones != 0 && ones != end - begin) ? hg.netWeight[e] : 0;
+    }
+    return cut;
+}
+
+int computeKWayCutSize(const Hypergraph &hg, const vector<int> &partition)
+{
+    size_t numPins = hg.netCells.size();
+    vector<unsigned long long> pinMask(numPins);
+    const int *cells = hg.netCells.data();
+    for (size_t k = 0; k < numPins; ++k)
+        pinMask[k] = 1ULL << partition[cells[k]];
+
+    // 每條 net 把 pin 的 die bit OR 起來，bit 數就是跨越的 die 數
+    const unsigned long long *mask = pinMask.data();
+    int cut = 0;
+    for (int e = 0; e < hg.numNets; ++e) {
+        unsigned long long span = 0;
+        for (int k = hg.netCellStart[e]; k < hg.netCellStart[e + 1]; ++k)
+            span |= mask[k];
+        if (span)
+            cut += hg.netWeight[e] * (__builtin_popcountll(span) - 1);
+    }
+    return cut;
+}
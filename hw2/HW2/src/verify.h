@@ -0,0 +1,22 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include <vector>
+#include "hypergraph.h"
+
+using namespace std;
+
+/************************************
+ * cut size 驗證：不依賴 FM 的 gain / net 計數，直接由 partition 與 CSR 重新計算
+ *   先把每個 pin 所在的 die 依 netCells 的順序抄成連續的陣列，
+ *   再對每條 net 連續的一段做 reduction (可被編譯器向量化)
+ *   FM / KWayFM 在 debug build (沒有 -DNDEBUG) 每個 pass 結束時 assert 增量維護的 cutSize 與此相同，
+ *   release build 只有 --verify 時才會呼叫
+ ************************************/
+
+// two-way：兩邊都有 pin 的 net 權重和
+int computeCutSize(const Hypergraph &hg, const vector<char> &partition);
+// K-way (K <= 64)：每條 net 的 weight * (跨越的 die 數 - 1)
+int computeKWayCutSize(const Hypergraph &hg, const vector<int> &partition);
+
+#endif // VERIFY_H
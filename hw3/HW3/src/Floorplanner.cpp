@@ -10,16 +10,18 @@ Pad::Pad() : x(0), y(0) {}
 Pad::Pad(const string& n, int _x, int _y) : name(n), x(_x), y(_y) {}
 
 // --- Net ---
-Net::Net() {}
-Net::Net(const string& n) : name(n) {}
+Net::Net() : padMinX(INT_MAX), padMaxX(INT_MIN), padMinY(INT_MAX), padMaxY(INT_MIN) {}
+Net::Net(const string& n) : name(n), padMinX(INT_MAX), padMaxX(INT_MIN), padMinY(INT_MAX), padMaxY(INT_MIN) {}
 
 // --- Floorplanner ---
 Floorplanner::Floorplanner()
  : numHardBlocks(0), numPads(0), numNets(0),
    outlineW(0), outlineH(0),
-   best_wirelength(INT_MAX),
+   best_wirelength(INT_MAX), minShape(0),
    dead_space_ratio(0.0),
-   total_block_area(0)
+   total_block_area(0),
+   numUndo(0), canUndo(false),
+   totalWL(0), wlValid(false), stamp(0)
 {
 }
 
@@ -58,7 +60,7 @@ void Floorplanner::set_seed() {
     } else {
         seed = time(NULL);
     }
-    srand(seed);
+    rng.seed(seed);
 }
 
 
@@ -75,7 +77,8 @@ void Floorplanner::readInput(const string& inFile) {
         fin >> token; // "HardBlock"
         string bname; int w, h;
         fin >> bname >> w >> h;
-        blocks[bname] = HardBlock(bname, w, h);
+        blockId[bname] = blocks.size();
+        blocks.push_back(HardBlock(bname, w, h));
         total_block_area += (long long)w*h;
     }
 
@@ -89,6 +92,7 @@ void Floorplanner::readInput(const string& inFile) {
 
     fin >> token >> numNets; // "NumNets <K>"
     nets.resize(numNets);
+    blockNets.assign(numHardBlocks, vector<int>());
     for(int i=0; i<numNets; i++){
         fin >> token; // "Net"
         string net_name; int deg;
@@ -100,8 +104,25 @@ void Floorplanner::readInput(const string& inFile) {
             string pin_name;
             fin >> pin_name;
             nets[i].pins.push_back(pin_name);
+
+            // pin 先解析成 block ID / pad 座標，算 HPWL 時不再查表
+            Net &net = nets[i];
+            auto bit = blockId.find(pin_name);
+            auto pit = pads.find(pin_name);
+            if(bit != blockId.end()) {
+                net.blockPins.push_back(bit->second);
+                if(blockNets[bit->second].empty() || blockNets[bit->second].back() != i)
+                    blockNets[bit->second].push_back(i);
+            } else if(pit != pads.end()) {
+                net.padMinX = min(net.padMinX, pit->second.x);
+                net.padMaxX = max(net.padMaxX, pit->second.x);
+                net.padMinY = min(net.padMinY, pit->second.y);
+                net.padMaxY = max(net.padMaxY, pit->second.y);
+            }
         }
     }
+    netWL.assign(numNets, 0);
+    netStamp.assign(numNets, 0);
     fin.close();
 }
 
@@ -114,12 +135,12 @@ void Floorplanner::calcOutline() {
 }
 
 // initSolution：依面積排序，並以 row 拆分
-vector<string> Floorplanner::initSolution() {
+vector<int> Floorplanner::initSolution() {
     vector<HardBlock> sorted_hardblocks;
 
     // 取得硬塊，必要時進行 90 度旋轉
-    for (auto &kv : blocks) {
-        HardBlock tmp = kv.second;
+    for (const HardBlock &b : blocks) {
+        HardBlock tmp = b;
         // 若硬塊的寬小於高，則旋轉（互換寬高，並記錄 rotated 狀態）
         if(tmp.w < tmp.h){
             swap(tmp.w, tmp.h);
@@ -136,42 +157,49 @@ vector<string> Floorplanner::initSolution() {
     );
 
 
-    vector<vector<string>> rows;
+    vector<vector<int>> rows;
     vector<int> rowWidths; // 記錄每一 row 的累積寬度
     // 初始化第一個 row
-    rows.push_back(vector<string>());
+    rows.push_back(vector<int>());
     rowWidths.push_back(0);
 
     // 將排序後的硬塊依序放入 row，若累積寬度超過 outlineW，則建立新 row
     for (const auto &hardblock : sorted_hardblocks) {
         int blockWidth = hardblock.w;
         if (rowWidths.back() + blockWidth > outlineW) {
-            rows.push_back(vector<string>());
+            rows.push_back(vector<int>());
             rowWidths.push_back(0);
         }
-        rows.back().push_back(hardblock.name);
+        rows.back().push_back(blockId[hardblock.name]);
         rowWidths.back() += blockWidth;
     }
 
     // 產生 Polish Expression：row 中各 operand 以 "V" 連接；各 row 以 "H" 連接
-    vector<string> expression;
+    vector<int> expression;
     expression.reserve(sorted_hardblocks.size() * 2 - 1);
     for (size_t i = 0; i < rows.size(); i++) {
         for (int j = 0; j < rows[i].size(); ++j) {
             expression.push_back(rows[i][j]);
             if (j >= 1)
-                expression.push_back("V");
+                expression.push_back(CUT_V);
         }
         if (i >= 1)
-            expression.push_back("H");
+            expression.push_back(CUT_H);
     }
 
     return expression;
 }
 
 
+// place
+void Floorplanner::place(const vector<int>& sol) {
+    int width, height;
+    getArea(sol, width, height, false);
+    update_coord(sol.size() - 1, minShape, Coord(0, 0));
+}
+
 // getCost
-pair<bool, long long> Floorplanner::getCost(const vector<string>& sol, bool withWirelength) {
+pair<bool, long long> Floorplanner::getCost(const vector<int>& sol, bool withWirelength) {
 
     int width, height, penalty = 0;
     long long areaCost = 0;
@@ -180,7 +208,7 @@ pair<bool, long long> Floorplanner::getCost(const vector<string>& sol, bool with
     areaCost = getArea(sol, width, height, withWirelength);
 
     if(withWirelength)
-        wirelength = getWirelength();
+        wirelength = updateWirelength();
 
     int penaltyFactor = 10;
     if(areaCost != 0 )
@@ -191,166 +219,162 @@ pair<bool, long long> Floorplanner::getCost(const vector<string>& sol, bool with
 
 
 
-vector<Node> Floorplanner::stockmeyer(const std::vector<Node>& left, const std::vector<Node>& right, const std::string& opType, int parentIndex){
-    // 1) 產生「笛卡兒積」(Cartesian Product)
-    //    每一個 (l, r) 配對都形成一個新的 (w, h)
-    vector<Node> candidate;
-    candidate.reserve(left.size() * right.size());
-    for (int i = 0; i < (int)left.size(); i++) {
-        for (int j = 0; j < (int)right.size(); j++) {
-            int newW = 0, newH = 0;
-
-            if (opType == "V") {
-                // 垂直切割 => w = w_l + w_r, h = max(h_l, h_r)
-                newW = left[i].width + right[j].width;
-                newH = std::max(left[i].height, right[j].height);
-            } else {
-                // 水平切割 => w = max(w_l, w_r), h = h_l + h_r
-                newW = std::max(left[i].width, right[j].width);
-                newH = left[i].height + right[j].height;
-            }
-
-            Node n(
-                opType,                // type: "V" / "H"
-                parentIndex,           // index (對應 polish expression 裡的運算子位置)
-                newW, newH,            // 合併後的 width, height
-                left[i].index, i,      // left_from, left_at
-                right[j].index, j,     // right_from, right_at
-                Coord(0, 0)            // coord: 先設 (0,0)，後面再 update_coord
-            );
-
-            candidate.push_back(n);
+/******************************************************
+  Stockmeyer 合併：left / right 都是依 width 遞增 (height 遞減) 的 Pareto curve
+  V: w = w_l + w_r, h = max(h_l, h_r)
+     從兩邊最窄的 shape 開始，每次把 height 較大 (卡住 h 的) 那一邊換成下一個較寬的 shape
+  H: w = max(w_l, w_r), h = h_l + h_r
+     從兩邊最寬 (最矮) 的 shape 開始，每次把 width 較大的那一邊換成前一個較窄的 shape
+  兩者都只走 |l| + |r| - 1 步，被支配的 (同 h 更寬 / 同 w 更高) 邊走邊丟掉
+  out 也依 width 遞增
+******************************************************/
+void Floorplanner::stockmeyer(const std::vector<Node>& left, const std::vector<Node>& right, int opType, int parentIndex, std::vector<Node>& out){
+    out.clear();
+    if (opType == CUT_V) {
+        int i = 0, j = 0;
+        while (i < (int)left.size() && j < (int)right.size()) {
+            const Node &l = left[i], &r = right[j];
+            int newW = l.width + r.width;
+            int newH = std::max(l.height, r.height);
+            // width 只會變大，height 沒有變小就是被前一個支配
+            if (out.empty() || newH < out.back().height)
+                out.push_back(Node{opType, parentIndex, newW, newH, l.index, i, r.index, j});
+            if (l.height > r.height)
+                i++;
+            else if (l.height < r.height)
+                j++;
+            else
+                i++, j++;
         }
-    } 
-
-    // 2) 針對 candidate 做「二維支配修剪 (dominance pruning)」
-    //    這裡的作法是先依 width 做遞增排序，再掃描 height 以去除在 (w,h) 上被支配的解。
-    //    之後常見還會再依 height 排序做一次類似檢查，避免「寬稍大、高明顯更小」的組合意外被砍。
-    //    以下示範先做「寬度排序 + 一次掃描」。
-    std::sort(candidate.begin(), candidate.end(), 
-        [](const Node &a, const Node &b) {
-            if(a.width == b.width) return a.height < b.height;
-            return a.width < b.width;
+    } else {
+        int i = left.size() - 1, j = right.size() - 1;
+        while (i >= 0 && j >= 0) {
+            const Node &l = left[i], &r = right[j];
+            int newW = std::max(l.width, r.width);
+            int newH = l.height + r.height;
+            // width 只會變小：同 height 時新的 shape 支配前一個
+            if (!out.empty() && newH == out.back().height)
+                out.pop_back();
+            out.push_back(Node{opType, parentIndex, newW, newH, l.index, i, r.index, j});
+            if (l.width > r.width)
+                i--;
+            else if (l.width < r.width)
+                j--;
+            else
+                i--, j--;
         }
-    );
+        std::reverse(out.begin(), out.end());
+    }
+}
 
-    std::vector<Node> pruned;
-    pruned.reserve(candidate.size());
+// 從位置 index 的第 at 個 shape 往下放座標 (curves 不會被改動)
+void Floorplanner::update_coord(int index, int at, Coord coord) {
+    const Node &n = curves[index][at];
 
-    int bestH = INT_MAX;
-    for (auto &c : candidate) {
-        // 如果發現 height 明顯更小，則保留
-        if (c.height < bestH) {
-            pruned.push_back(c);
-            bestH = c.height;
-        }
-        // 否則就被支配，捨棄
+    if(n.type == CUT_V) {
+        update_coord(n.left_from, n.left_at, coord);
+        update_coord(n.right_from, n.right_at, Coord(coord.x + curves[n.left_from][n.left_at].width, coord.y));
+    } else if(n.type == CUT_H) {
+        update_coord(n.left_from, n.left_at, coord);
+        update_coord(n.right_from, n.right_at, Coord(coord.x, coord.y + curves[n.left_from][n.left_at].height));
+    } else {
+        HardBlock &b = blocks[n.type];
+        bool rotated = n.width != b.w;
+        if(b.coord.x != coord.x || b.coord.y != coord.y || b.rotated != rotated)
+            changedBlocks.push_back(n.type);
+        b.coord = coord;
+        b.rotated = rotated;
     }
+}
 
-    // 3) (選擇性) 再依 height 排序，做相同掃描，以更嚴格方式留下真正的 Pareto 最優解
-    //    如果想要保留「寬略大、高更小」的可能，需要：
-    //    - 先把 pruned 再依 height 遞增排序
-    //    - 再類似方法掃 width
-    //    這樣才是最完整的 2D pruning。
-    //
-    //    這裡如果你想更完整，可以加一段：
-    
-    std::sort(pruned.begin(), pruned.end(), 
-        [](const Node &a, const Node &b) {
-            if(a.height == b.height) return a.width < b.width;
-            return a.height < b.height;
+/******************************************************
+  依序掃過 sol 並用 stack 重建每個運算子的左右子節點 (只有整數，O(n))，
+  一個位置要重算 shape curve 的條件是：
+    內容 (block ID / 運算子) 與上一次不同、左右子節點的位置不同，或子節點被重算過
+  postfix 中子節點都在父節點之前，所以同一次掃描就能把「被重算」傳到所有祖先
+  M1 只換兩個 operand，M2 只換一段運算子，M3 只改變兩個相鄰位置附近的結構，
+  要重算的只有這些位置到 root 的路徑
+******************************************************/
+void Floorplanner::updateCurves(const vector<int>& sol) {
+    int n = sol.size();
+    if((int)curveExpr.size() != n) {
+        // 第一次 (或長度不同)：上一次的內容設成不可能的值，所有位置都會重算
+        curveExpr.assign(n, INT_MIN);
+        leftChild.assign(n, INT_MIN);
+        rightChild.assign(n, INT_MIN);
+        curves.assign(n, vector<Node>());
+    }
+    prevExpr.swap(curveExpr);
+    prevLeft.swap(leftChild);
+    prevRight.swap(rightChild);
+    curveExpr = sol;
+    leftChild.resize(n);
+    rightChild.resize(n);
+    dirty.assign(n, 0);
+    stk.clear();
+    numUndo = 0;
+    canUndo = true;
+
+    for(int i = 0; i < n; i++) {
+        int l = -1, r = -1;
+        if(isCut(sol[i])) {
+            r = stk.back();
+            stk.pop_back();
+            l = stk.back();
+            stk.pop_back();
         }
-    );
-    std::vector<Node> pruned2;
-    pruned2.reserve(pruned.size());
-    int bestW = INT_MAX;
-    for (auto &c : pruned) {
-        if (c.width < bestW) {
-            pruned2.push_back(c);
-            bestW = c.width;
+        stk.push_back(i);
+        leftChild[i] = l;
+        rightChild[i] = r;
+        if(sol[i] == prevExpr[i] && l == prevLeft[i] && r == prevRight[i] &&
+           (l == -1 || (!dirty[l] && !dirty[r])))
+            continue;
+
+        // 舊的 curve 移到 undoCurves (swap，不複製)
+        dirty[i] = 1;
+        if(numUndo == (int)undoCurves.size())
+            undoCurves.emplace_back();
+        undoCurves[numUndo].first = i;
+        undoCurves[numUndo].second.swap(curves[i]);
+        numUndo++;
+
+        if(l != -1) {
+            stockmeyer(curves[l], curves[r], sol[i], i, curves[i]);
+        } else {
+            const HardBlock &hardblock = blocks[sol[i]];
+            int width = hardblock.w, height = hardblock.h;
+            vector<Node> &res = curves[i];
+            res.clear();
+            // 依 width 遞增
+            res.push_back(Node{sol[i], i, min(width, height), max(width, height), -1, -1, -1, -1});
+            if(width != height)
+                res.push_back(Node{sol[i], i, max(width, height), min(width, height), -1, -1, -1, -1});
         }
     }
-
-    // pruned2 即為最後真正保留下來的一組 (w,h)
-    return pruned2;
-
 }
 
-void Floorplanner::update_coord(std::vector<std::vector<Node>>& record, int index, int min_at) {
-    record[index] = {record[index][min_at]};
-
-    Node* n = &record[index][0];
-    Node* left = &record[n->left_from][n->left_at];
-    Node* right = &record[n->right_from][n->right_at];
-
-    if(n->type == "V") {
-        left->coord = n->coord;
-        right->coord = Coord(n->coord.x + left->width, n->coord.y);
-        update_coord(record, n->left_from, n->left_at);
-        update_coord(record, n->right_from, n->right_at);
-    } else if(n->type == "H") {
-        left->coord = n->coord;
-        right->coord = Coord(n->coord.x, n->coord.y + left->height);
-        update_coord(record, n->left_from, n->left_at);
-        update_coord(record, n->right_from, n->right_at);
-    } else {
-        blocks[n->type].coord = n->coord;
-        if(n->width != blocks[n->type].w) {
-            blocks[n->type].rotated = true;
-        } else {
-            blocks[n->type].rotated = false;
-        }
-    }
+void Floorplanner::undoArea() {
+    if(!canUndo)
+        return;
+    for(int k = numUndo - 1; k >= 0; k--)
+        curves[undoCurves[k].first].swap(undoCurves[k].second);
+    numUndo = 0;
+    canUndo = false;
+    curveExpr.swap(prevExpr);
+    leftChild.swap(prevLeft);
+    rightChild.swap(prevRight);
 }
 
 // Stockmeyer Algorithm
-int Floorplanner::getArea(const vector<string>& sol, int &w, int &h, bool withWirelength) {
-    // Variables
-    stack<vector<Node>> stk;
-    vector<vector<Node>> record;
-    std::vector<Node> result;
-
-
-    // Stockmeyer
-    for(int i = 0; i < sol.size(); i++) {
-        if(sol[i] == "V" || sol[i] == "H") {
-            vector<Node> rightChild = stk.top();
-            stk.pop();
-            vector<Node> leftChild = stk.top();
-            stk.pop();
-            vector<Node> res = stockmeyer(leftChild, rightChild, sol[i], i);
-            stk.push(res);
-            record.push_back(res);
-        } else {
-            HardBlock hardblock = blocks[sol[i]];
-            int width = hardblock.w, height = hardblock.h;
-            if(width != height) {
-                vector<Node> res = {
-                    Node(sol[i], i, width, height, -1, -1, -1, -1, Coord(0, 0)),
-                    Node(sol[i], i, height, width, -1, -1, -1, -1, Coord(0, 0))
-                };
-                
-                sort(res.begin(), res.end(), [](Node a, Node b) {
-                    return a.width < b.width;
-                });
-
-                stk.push(res);
-                record.push_back(res);
-            } else {
-                vector<Node> res = {
-                    Node(sol[i], i, width, height, -1, -1, -1, -1, Coord(0, 0))
-                };
-                stk.push(res);
-                record.push_back(res);
-            }
-        }
-    }
+int Floorplanner::getArea(const vector<int>& sol, int &w, int &h, bool withWirelength) {
+    updateCurves(sol);
 
     // Get min area
     int width, height, area, min_width, min_height, min_area = INT_MAX, min_index;
     int minAreaCost = numeric_limits<int>::max();
-    result = stk.top();
-    for(int i = 0; i < result.size(); i++) {
+    const vector<Node> &result = curves.back();
+    // 由矮到寬掃 (cost 相同時取 height 較小的 shape)
+    for(int i = (int)result.size() - 1; i >= 0; i--) {
         int areaCost = 0;
         width = result[i].width;
         height = result[i].height;
@@ -378,8 +402,9 @@ int Floorplanner::getArea(const vector<string>& sol, int &w, int &h, bool withWi
     }
 
     // Update coordinates
+    minShape = min_index;
     if(minAreaCost==0 && withWirelength) 
-        update_coord(record, record.size() - 1, min_index);
+        update_coord(sol.size() - 1, min_index, Coord(0, 0));
 
     // Result
     w = min_width;
@@ -388,46 +413,62 @@ int Floorplanner::getArea(const vector<string>& sol, int &w, int &h, bool withWi
     return minAreaCost;
 }
 
+long long Floorplanner::netWirelength(const Net& net) const {
+    int minx = net.padMinX, maxx = net.padMaxX;
+    int miny = net.padMinY, maxy = net.padMaxY;
+    for(int id : net.blockPins){
+        const HardBlock &b = blocks[id];
+        int bw = b.rotated? b.h : b.w;
+        int bh = b.rotated? b.w : b.h;
+        // 中心點取 floor (座標不為負)
+        int cx = b.coord.x + bw/2;
+        int cy = b.coord.y + bh/2;
+        minx = min(minx, cx);
+        maxx = max(maxx, cx);
+        miny = min(miny, cy);
+        maxy = max(maxy, cy);
+    }
+    if(minx > maxx)     // 沒有任何認得的 pin
+        return 0;
+    return (long long)(maxx - minx) + (long long)(maxy - miny);
+}
+
 // 計算 HPWL
 long long Floorplanner::getWirelength() {
-    long long totalWL=0;
-    for(const auto &net : nets) {
-        int minx=INT_MAX, maxx=INT_MIN;
-        int miny=INT_MAX, maxy=INT_MIN;
-        for(const auto & pin_name : net.pins){
-            int cx=0, cy=0;
-            // block?
-            if(blocks.find(pin_name)!=blocks.end()){
-                auto &b = blocks[pin_name];
-                int bw = b.rotated? b.h : b.w;
-                int bh = b.rotated? b.w : b.h;
-                double cxf = b.coord.x + bw/2.0;
-                double cyf = b.coord.y + bh/2.0;
-                cx = (int)floor(cxf);
-                cy = (int)floor(cyf);
-            } else if(pads.find(pin_name)!=pads.end()){
-                // pad
-                cx = pads[pin_name].x;
-                cy = pads[pin_name].y;
-            } else {
+    totalWL = 0;
+    for(int e = 0; e < numNets; e++) {
+        netWL[e] = netWirelength(nets[e]);
+        totalWL += netWL[e];
+    }
+    changedBlocks.clear();
+    wlValid = true;
+    return totalWL;
+}
+
+long long Floorplanner::updateWirelength() {
+    if(!wlValid)
+        return getWirelength();
+    // stamp 讓同一個 net 在一次更新裡只算一次
+    if(++stamp == INT_MAX) {
+        fill(netStamp.begin(), netStamp.end(), 0);
+        stamp = 1;
+    }
+    for(int id : changedBlocks) {
+        for(int e : blockNets[id]) {
+            if(netStamp[e] == stamp)
                 continue;
-            }
-            minx = min(minx, cx);
-            maxx = max(maxx, cx);
-            miny = min(miny, cy);
-            maxy = max(maxy, cy);
+            netStamp[e] = stamp;
+            long long wl = netWirelength(nets[e]);
+            totalWL += wl - netWL[e];
+            netWL[e] = wl;
         }
-        totalWL += (long long)(maxx - minx) + (long long)(maxy - miny);
     }
+    changedBlocks.clear();
     return totalWL;
 }
 
 
-bool Floorplanner::isCut(string s){
-    return s == "V" || s == "H";
-}
-
-bool Floorplanner::isSkewed(const vector<string> &expression, int idx)
+bool Floorplanner::isSkewed(const vector<int> &expression, int idx)
 {
     if (isCut(expression[idx]))
     {
@@ -442,7 +483,7 @@ bool Floorplanner::isSkewed(const vector<string> &expression, int idx)
     return true;
 }
 
-bool Floorplanner::satisfyBallot(const vector<string> &expression, int idx)
+bool Floorplanner::satisfyBallot(const vector<int> &expression, int idx)
 {
     if (isCut(expression[idx + 1]))
     {
@@ -457,7 +498,7 @@ bool Floorplanner::satisfyBallot(const vector<string> &expression, int idx)
 }
 
 
-void Floorplanner::swap_adjacent_operand(vector<string>& expression) {
+void Floorplanner::swap_adjacent_operand(vector<int>& expression) {
     vector<int> indices;
     for (int i = 0; i + 1 < expression.size(); ++i)
         if ((!isCut(expression[i]) && isCut(expression[i + 1])) ||
@@ -466,7 +507,7 @@ void Floorplanner::swap_adjacent_operand(vector<string>& expression) {
 
     while (!indices.empty())
     {
-        int r = rand() % indices.size();
+        int r = rng.next() % indices.size();
         if (isSkewed(expression, indices[r]) && satisfyBallot(expression, indices[r]))
         {
             swap(expression[indices[r]], expression[indices[r] + 1]);
@@ -482,37 +523,37 @@ void Floorplanner::swap_adjacent_operand(vector<string>& expression) {
 
 
 
-void Floorplanner::swap_random_operand(vector<string>& expression) {
+void Floorplanner::swap_random_operand(vector<int>& expression) {
     vector<int> indices;
     for (int i = 0; i < expression.size(); ++i)
-        if (expression[i] != "V" && expression[i] != "H")
+        if (!isCut(expression[i]))
             indices.emplace_back(i);
 
-    int l = rand() % indices.size();
-    int r = rand() % indices.size();
+    int l = rng.next() % indices.size();
+    int r = rng.next() % indices.size();
     while (l == r)
-        r = rand() % indices.size();
+        r = rng.next() % indices.size();
     swap(expression[indices[l]], expression[indices[r]]);
 }
 
-void Floorplanner::invert_chain(vector<string>& expression) {
+void Floorplanner::invert_chain(vector<int>& expression) {
     vector<int> indices;
     for (int i = 1; i < expression.size(); ++i)
         if (!isCut(expression[i - 1]) && isCut(expression[i]))
             indices.emplace_back(i);
 
-    int r = rand() % indices.size();
+    int r = rng.next() % indices.size();
     for (int i = indices[r]; i < expression.size(); ++i)
     {
         if (!isCut(expression[i]))
             break;
-        expression[i] = (expression[i] == "H") ? "V" : "H";
+        expression[i] = (expression[i] == CUT_H) ? CUT_V : CUT_H;
     }
 }
 
 // 產生鄰居解
-vector<string> Floorplanner::genNeighbor(vector<string> expression, int r) {
-    vector<string> neighbor = expression;
+vector<int> Floorplanner::genNeighbor(const vector<int>& expression, int r) {
+    vector<int> neighbor = expression;
 
     if(r == 0) {
         swap_adjacent_operand(neighbor);
@@ -527,13 +568,34 @@ vector<string> Floorplanner::genNeighbor(vector<string> expression, int r) {
 
 
 
+int Floorplanner::annealStep(vector<int>& sol, long long& cost, double T, bool withWirelength) {
+    int r = (withWirelength) ? 2 : rng.next() % 3;
+    vector<int> neighbor = genNeighbor(sol, r);
+    auto [inOutline, neighbor_cost] = getCost(neighbor, withWirelength);
+    if (withWirelength && !inOutline) {
+        // 新解超出 outline，直接跳過
+        undoArea();
+        return MOVE_REJECTED;
+    }
+
+    long long delta_cost = neighbor_cost - cost;
+    bool rand_accept = (double)rng.next() / RAND_MAX < exp(-1 * (delta_cost) / T);
+    if(delta_cost <= 0 || rand_accept) {
+        sol.swap(neighbor);
+        cost = neighbor_cost;
+        return delta_cost > 0 ? MOVE_UPHILL : MOVE_DOWNHILL;
+    }
+    undoArea();
+    return MOVE_REJECTED;
+}
+
 // 模擬退火
-pair<vector<string>, int> Floorplanner::simulatedAnnealing(vector<string> expression, bool withWirelength, double initTemperature, double minTemperature, double coolingCoefficient, int tryingTimes, double maxRejectRatio, Timer &timer, double timeLimit) {
+pair<vector<int>, int> Floorplanner::simulatedAnnealing(vector<int> expression, bool withWirelength, double initTemperature, double minTemperature, double coolingCoefficient, int tryingTimes, double maxRejectRatio, Timer &timer, double timeLimit) {
     // srand(seed_);
 
-    vector<string> curr_sol = expression;
+    vector<int> curr_sol = expression;
 
-    vector<string> best_sol = curr_sol;
+    vector<int> best_sol = curr_sol;
 
     // Parameters
     double T = initTemperature, T_MIN = minTemperature, T_DECAY = coolingCoefficient;
@@ -560,24 +622,12 @@ pair<vector<string>, int> Floorplanner::simulatedAnnealing(vector<string> expres
                 // minAreaCost = getCost(best_sol, withWirelength).second;
                 return {best_sol, min_cost};
             }
-            int r = (withWirelength) ? 2 : rand() % 3;
-            vector<string> neighbor = genNeighbor(curr_sol, r);
-            auto [inOutline, neighbor_cost] = getCost(neighbor, withWirelength);
+            int result = annealStep(curr_sol, curr_cost, T, withWirelength);
             gen_cnt++;
-            if (withWirelength && !inOutline) {
-                // 新解超出 outline，直接跳過
-                reject_cnt++;
-                continue;
-            }
-
-            long long delta_cost = neighbor_cost - curr_cost;
-            bool rand_accept = (double)rand() / RAND_MAX < exp(-1 * (delta_cost) / T);
-            if(delta_cost <= 0 || rand_accept) {
-                if(delta_cost > 0) {
+            if(result != MOVE_REJECTED) {
+                if(result == MOVE_UPHILL) {
                     uphill_cnt++;
                 }
-                curr_sol = neighbor;
-                curr_cost = neighbor_cost;
                 if(curr_cost < min_cost) {
                     min_cost = curr_cost;
                     best_sol = curr_sol;
@@ -609,8 +659,7 @@ void Floorplanner::writeOutput(const string& outFile) {
     }
     fout << "Wirelength " << getWirelength() << "\n";
     fout << "NumHardBlocks " << numHardBlocks << "\n";
-    for(const auto &kv : blocks){
-        const auto &b = kv.second;
+    for(const auto &b : blocks){
         fout << b.name << " " << b.coord.x << " " << b.coord.y << " "
              << (b.rotated?1:0) << "\n";
     }
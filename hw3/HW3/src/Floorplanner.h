@@ -30,31 +30,65 @@ struct Pad {
 struct Net {
     string name;
     vector<string> pins;
+    // 讀檔時解析好的 pin：block ID，以及所有 pad 的 bounding box (pad 不會動)
+    vector<int> blockPins;
+    int padMinX, padMaxX, padMinY, padMaxY;
     Net();
     Net(const string& n);
 };
 
 
+// 每個 Floorplanner 自己的亂數產生器，序列與 glibc 的 srand / rand 完全相同 (TYPE_3 additive feedback)
+// 單一 chain 用同一個 seed 時結果與原本一樣，多個 replica 各自一份時 thread 之間互不影響
+struct Random {
+    uint32_t state[31];
+    int f, r;
+
+    Random() { seed(1); }
+    void seed(unsigned s) {
+        if(s == 0)
+            s = 1;
+        long word = (int32_t)s;
+        state[0] = s;
+        for(int i = 1; i < 31; i++) {
+            long hi = word / 127773, lo = word % 127773;
+            word = 16807 * lo - 2836 * hi;
+            if(word < 0)
+                word += 2147483647;
+            state[i] = word;
+        }
+        f = 3, r = 0;
+        for(int i = 0; i < 310; i++)
+            next();
+    }
+    // 0 ~ RAND_MAX
+    int next() {
+        state[f] += state[r];
+        int result = state[f] >> 1;
+        if(++f == 31)
+            f = 0;
+        if(++r == 31)
+            r = 0;
+        return result;
+    }
+};
+
+// annealStep 的結果
+const int MOVE_REJECTED = 0;
+const int MOVE_DOWNHILL = 1;
+const int MOVE_UPHILL = 2;
+
+// Polish expression 的編碼：>= 0 是 block ID (blocks 的索引)，負數是運算子
+const int CUT_V = -1;
+const int CUT_H = -2;
+
+// shape curve 上的一個點 (POD，合併時大量複製)
 struct Node {
-    // Variables
-    std::string type;
-    int index;
+    int type;       // block ID 或 CUT_V / CUT_H
+    int index;      // 在 expression 裡的位置
     int width, height;
-    int left_from, left_at;
+    int left_from, left_at;     // 左子節點的位置與它在 curve 上的第幾個 shape (operand 為 -1)
     int right_from, right_at;
-    Coord coord;
-
-    // Constructors
-    Node();
-    Node(string type, int index, int width, int height, int left_from, int left_at, int right_from, int right_at, Coord coord) {
-        this->type = type;
-        this->index = index;
-        this->width = width, this->height = height;
-        this->left_from = left_from, this->left_at = left_at;
-        this->right_from = right_from, this->right_at = right_at;
-        this->coord = coord;
-    }
-    
 };
 
 // Floorplanner 類別
@@ -65,8 +99,10 @@ public:
     int numPads;
     int numNets;
     int seed;
-    unordered_map<string, HardBlock> blocks;
-    unordered_map<string, HardBlock> best_blocks;
+    Random rng;
+    vector<HardBlock> blocks;               // 依輸入順序，索引就是 block ID
+    vector<HardBlock> best_blocks;
+    unordered_map<string, int> blockId;     // block 名稱 -> ID (只在讀檔與算 HPWL 時用)
     unordered_map<string, Pad> pads;
     vector<Net> nets;
 
@@ -75,10 +111,34 @@ public:
 
     // 最佳解資訊
     int best_wirelength;
+    int minShape;       // 上一次 getArea 在 root curve 上選到的 shape
 
     // 其他參數
     double dead_space_ratio;
     long long total_block_area;
+
+    // 增量 Stockmeyer：slicing tree 的節點就是 expression 的位置，curves[i] 是位置 i 的 shape curve
+    // getArea 只重算內容或左右子節點有變的位置以及它們的祖先 (M1/M2/M3 都只動到少數位置)，
+    // 被換掉的 curve 留在 undoCurves，undoArea 可以把上一次 getArea 整個撤銷
+    vector<int> curveExpr, prevExpr;        // curves 目前對應的 expression / 上一次的
+    vector<int> leftChild, rightChild;      // 運算子位置的左右子節點位置 (operand 為 -1)
+    vector<int> prevLeft, prevRight;
+    vector<vector<Node>> curves;
+    vector<pair<int, vector<Node>>> undoCurves;
+    int numUndo;
+    bool canUndo;
+    vector<int> stk;
+    vector<char> dirty;
+
+    // 增量 HPWL：netWL[e] 是 net e 目前的 HPWL，totalWL 是總和
+    // update_coord 把座標或旋轉有變的 block 記在 changedBlocks，updateWirelength 只重算它們所在的 net
+    vector<vector<int>> blockNets;          // block ID -> 接到的 net
+    vector<long long> netWL;
+    long long totalWL;
+    bool wlValid;                           // false => 下一次 updateWirelength 全部重算
+    vector<int> changedBlocks;
+    vector<int> netStamp;
+    int stamp;
     
 
 public:
@@ -91,44 +151,63 @@ public:
     void calcOutline();
 
     // 初始化解
-    vector<string> initSolution();
+    vector<int> initSolution();
+
+    // 合併左右子節點的 shape curve (線性時間)，結果寫到 out
+    void stockmeyer(const vector<Node>& l, const vector<Node>& r, int opType, int parentIndex, vector<Node>& out);
+
+    void update_coord(int index, int at, Coord coord);
 
-    vector<Node> stockmeyer(const vector<Node>& l, const vector<Node>& r, const string& opType, int parentIndex);
+    // 把 curves 更新成 sol 的 shape curve
+    void updateCurves(const vector<int>& sol);
 
-    void update_coord(vector<vector<Node>>& record, int index, int min_at);
+    // 撤銷上一次 getArea 對 curves 的更新 (SA 拒絕鄰居解時用)
+    void undoArea();
 
     // 計算 cost
-    pair<bool, long long>  getCost(const vector<string>& sol, bool withWirelength);
+    pair<bool, long long>  getCost(const vector<int>& sol, bool withWirelength);
 
     // pack => stockmeyer
-    int getArea(const vector<string>& sol, int &w, int &h, bool withWirelength);
+    int getArea(const vector<int>& sol, int &w, int &h, bool withWirelength);
 
-    // 計算 HPWL
+    // 依 sol 的 area cost 最小的 shape 設定 blocks 的座標 (不在 outline 內也會擺，block 不會重疊)
+    void place(const vector<int>& sol);
+
+    // 計算 HPWL (全部重算，並重設增量 HPWL 的 cache)
     long long getWirelength();
 
-    void invert_chain(vector<string>& sol);
+    // 只重算 changedBlocks 所在的 net，回傳總 HPWL
+    long long updateWirelength();
+
+    // net e 的 HPWL (block 用目前的座標)
+    long long netWirelength(const Net& net) const;
 
-    void swap_random_operand(vector<string>& sol);
+    void invert_chain(vector<int>& sol);
 
-    void swap_adjacent_operand(vector<string>& sol);
+    void swap_random_operand(vector<int>& sol);
+
+    void swap_adjacent_operand(vector<int>& sol);
 
     // 產生鄰居解
-    vector<string> genNeighbor(vector<string> sol, int r);
+    vector<int> genNeighbor(const vector<int>& sol, int r);
+
+    // 在溫度 T 做一次 move (產生鄰居解，依 Metropolis 準則接受或撤銷)，回傳 MOVE_*
+    int annealStep(vector<int>& sol, long long& cost, double T, bool withWirelength);
 
     // 模擬退火
-    pair<vector<string>, int> simulatedAnnealing(vector<string> expression, bool withWirelength, double initTemperature, double minTemperature, double coolingCoefficient, int tryingTimes, double maxRejectRatio, Timer &timer, double timeLimit);
+    pair<vector<int>, int> simulatedAnnealing(vector<int> expression, bool withWirelength, double initTemperature, double minTemperature, double coolingCoefficient, int tryingTimes, double maxRejectRatio, Timer &timer, double timeLimit);
     
 
     // 輸出
     void writeOutput(const string& outFile);
 
-    bool isCut(string s);
+    bool isCut(int s) const { return s < 0; }
 
-    bool isSkewed(const vector<string> &expression, int idx);
+    bool isSkewed(const vector<int> &expression, int idx);
 
-    bool satisfyBallot(const vector<string> &expression, int idx);
+    bool satisfyBallot(const vector<int> &expression, int idx);
 
-    bool isValidPolish(const vector<string>& expr);
+    bool isValidPolish(const vector<int>& expr);
     void set_seed();
     
 };
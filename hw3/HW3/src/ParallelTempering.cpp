@@ -0,0 +1,88 @@
+#include "ParallelTempering.h"
+
+ParallelTempering::ParallelTempering(Floorplanner &fp, int numThreads, unsigned seed)
+ : fp(fp), numThreads(max(1, numThreads)), seed(seed), numRuns(0)
+{
+}
+
+// 一個 replica 在自己的溫度下做 moves 次 move (area 階段放進 outline 就提早結束)
+void ParallelTempering::sweep(Replica &rep, bool withWirelength, int moves) {
+    for(int m = 0; m < moves; m++) {
+        if(rep.fp.annealStep(rep.sol, rep.cost, rep.T, withWirelength) == MOVE_REJECTED || rep.cost >= rep.bestCost)
+            continue;
+        rep.bestCost = rep.cost;
+        rep.bestSol = rep.sol;
+        if(!withWirelength && rep.cost == 0)
+            return;
+    }
+}
+
+pair<vector<int>, long long> ParallelTempering::run(const vector<int> &expression, bool withWirelength, double maxTemperature,
+                                                    double minTemperature, double coolingCoefficient, int tryingTimes,
+                                                    Timer &timer, double timeLimit) {
+    // 每個 replica 從同一個解出發，replica k 在第 k 高溫
+    // wirelength 階段只記錄 outline 內的解 (annealStep 只接受 outline 內的鄰居解)，不在 outline 內的起點不算
+    unsigned runSeed = seed + (unsigned)numRuns++ * numThreads;
+    vector<Replica> replicas(numThreads, Replica{fp, expression, 0, expression, 0, maxTemperature});
+    for(int k = 0; k < numThreads; k++) {
+        Replica &rep = replicas[k];
+        rep.fp.rng.seed(runSeed + k);
+        auto [inOutline, cost] = rep.fp.getCost(rep.sol, withWirelength);
+        rep.cost = rep.bestCost = cost;
+        if(withWirelength && !inOutline)
+            rep.bestCost = LLONG_MAX;
+        rep.T = maxTemperature * pow(ladderRatio, -k);
+    }
+    // level[i]：第 i 低溫的 replica
+    vector<int> level(numThreads);
+    for(int k = 0; k < numThreads; k++)
+        level[k] = numThreads - 1 - k;
+
+    Random rng;
+    rng.seed(~runSeed);
+    vector<int> bestSol = replicas[0].bestSol;
+    long long bestCost = replicas[0].bestCost;
+
+    int moves = fp.numHardBlocks * tryingTimes;
+    int round = 0, swaps = 0;
+    while(!(!withWirelength && bestCost == 0) && replicas[level.back()].T >= minTemperature && !timer.is_timeout(timeLimit)) {
+        vector<thread> threads;
+        for(int k = 1; k < numThreads; k++)
+            threads.emplace_back(&ParallelTempering::sweep, this, ref(replicas[k]), withWirelength, moves);
+        sweep(replicas[0], withWirelength, moves);
+        for(auto &th : threads)
+            th.join();
+        round++;
+
+        for(int k = 0; k < numThreads; k++) {
+            if(replicas[k].bestCost < bestCost) {
+                bestCost = replicas[k].bestCost;
+                bestSol = replicas[k].bestSol;
+            }
+        }
+
+        // 相鄰溫度交換 (這一輪從第 round % 2 低溫開始兩兩一組)
+        for(int i = round % 2; i + 1 < numThreads; i += 2) {
+            Replica &cold = replicas[level[i]], &hot = replicas[level[i + 1]];
+            double x = (1.0 / cold.T - 1.0 / hot.T) * (double)(cold.cost - hot.cost);
+            if(x >= 0 || (double)rng.next() / RAND_MAX < exp(x)) {
+                swap(cold.T, hot.T);
+                swap(level[i], level[i + 1]);
+                swaps++;
+            }
+        }
+        for(Replica &rep : replicas)
+            rep.T *= coolingCoefficient;
+    }
+    if(withWirelength) {
+        if(bestCost == LLONG_MAX) {
+            printf("Parallel tempering: %d replicas, %d rounds, no solution inside the outline\n", numThreads, round);
+            return {expression, replicas[0].cost};
+        }
+        // replica 的座標只對各自目前的解有效，所以回傳前用 fp 重算 bestSol 的座標
+        fp.place(bestSol);
+        fp.best_blocks = fp.blocks;
+    }
+    printf("Parallel tempering: %d replicas, %d rounds, %d swaps, best cost %lld\n", numThreads, round, swaps, bestCost);
+    return {bestSol, bestCost};
+}
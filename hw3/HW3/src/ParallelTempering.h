@@ -0,0 +1,49 @@
+#pragma once
+#include "Floorplanner.h"
+using namespace std;
+
+/******************************************************
+  Parallel tempering (replica exchange) 版本的模擬退火
+  numThreads 個 replica，各自一份 Floorplanner (curves / HPWL cache、亂數) 與目前的解，每個 replica 用一個 thread
+  溫度排成 ladder：replica k 從 maxTemperature / ladderRatio^k 開始，每一輪：
+    1. 每個 replica 在自己的溫度下做 numHardBlocks * tryingTimes 次 annealStep
+    2. 相鄰溫度的 replica 依 min(1, exp((1/T_i - 1/T_j)(E_i - E_j))) 交換溫度 (奇偶輪流，只交換溫度不複製解)
+    3. 整個 ladder 乘上 coolingCoefficient
+  ladder 固定不降溫時，低溫的 replica 很快就卡在 row 排法附近 (面積放得進去但 HPWL 很差)，
+  所以與單一 chain 相同地從高溫一路降下來，只是同時有好幾個錯開的溫度在跑並互相交換
+  結束條件：area 階段有 replica 放進 outline、最高溫低於 minTemperature，或超時
+  整個過程中最好的解 (area 階段：cost 最小的解；wirelength 階段：outline 內 HPWL 最小的解)
+  回傳給呼叫端；area 階段沒放進 outline 時由呼叫端從回傳的解再跑一次 (同單一 chain 的 restart)
+  wirelength 階段結束時用 fp 重算回傳解的座標存在 fp.best_blocks，沒找到 outline 內的解就原樣回傳 expression (fp.best_blocks 不動)
+  第 r 次 run 的 replica k 的 seed 是 seed + r * numThreads + k，交換用 ~(seed + r * numThreads)；
+  同樣的 seed 與 thread 數結果相同 (沒有超時的話)
+******************************************************/
+class ParallelTempering {
+public:
+    // 相鄰兩個 replica 的溫度比
+    static constexpr double ladderRatio = 2.0;
+
+    ParallelTempering(Floorplanner &fp, int numThreads, unsigned seed);
+
+    pair<vector<int>, long long> run(const vector<int> &expression, bool withWirelength, double maxTemperature,
+                                     double minTemperature, double coolingCoefficient, int tryingTimes,
+                                     Timer &timer, double timeLimit);
+
+private:
+    struct Replica {
+        Floorplanner fp;
+        vector<int> sol;
+        long long cost;
+        vector<int> bestSol;
+        long long bestCost;
+        double T;
+    };
+
+    Floorplanner &fp;
+    int numThreads;
+    unsigned seed;
+    // 已經跑過幾次 run，restart 時換一組 seed
+    int numRuns;
+
+    void sweep(Replica &rep, bool withWirelength, int moves);
+};
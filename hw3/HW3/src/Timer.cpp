@@ -1,20 +1,24 @@
 #include "Timer.h"
 
+static double seconds_since(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
 Timer::Timer() {
-    start_time = clock();
+    start_time = std::chrono::steady_clock::now();
     elapsed_time = 0;
 }
 
 void Timer::start() {
-    start_time = clock();
+    start_time = std::chrono::steady_clock::now();
 }
 
 void Timer::stop() {
-    elapsed_time = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+    elapsed_time = seconds_since(start_time);
 }
 
 void Timer::stop_acc() {
-    elapsed_time += (double)(clock() - start_time) / CLOCKS_PER_SEC;
+    elapsed_time += seconds_since(start_time);
 }
 
 bool Timer::is_timeout(double t) {
@@ -2,8 +2,8 @@
 
 class Timer {
 private:
-    // Variables
-    clock_t start_time;
+    // Variables (wall-clock：多個 thread 時 clock() 會把所有 thread 的 CPU 時間加起來)
+    std::chrono::steady_clock::time_point start_time;
     double elapsed_time;
 
 public:
@@ -0,0 +1,113 @@
+#include "Floorplanner.h"
+
+/******************************************************
+  stockmeyer() microbenchmark
+  用法: ./bench_stockmeyer [repeat] [seed]
+  對每個 curve 大小 n (左右各 n 個 shape，隨機的 Pareto curve)：
+  1. Floorplanner::stockmeyer (two-pointer merge)
+  2. 對照組：笛卡兒積 + 依 width / height 各排序一次做支配修剪 (舊的作法)
+  V / H 各做 repeat 次取平均，並確認兩者得到的 (w, h) 完全相同
+******************************************************/
+static double now()
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// n 個 shape：width 嚴格遞增、height 嚴格遞減
+static vector<Node> randomCurve(mt19937 &rng, int n, int index)
+{
+    vector<Node> curve(n);
+    int w = 1 + rng() % 8, h = 1;
+    for (int i = n - 1; i >= 0; i--) {
+        curve[i].height = h;
+        h += 1 + rng() % 8;
+    }
+    for (int i = 0; i < n; i++) {
+        curve[i] = Node{0, index, w, curve[i].height, -1, -1, -1, -1};
+        w += 1 + rng() % 8;
+    }
+    return curve;
+}
+
+static void cartesian(const vector<Node> &left, const vector<Node> &right, int opType, vector<Node> &out)
+{
+    vector<Node> candidate;
+    candidate.reserve(left.size() * right.size());
+    for (int i = 0; i < (int)left.size(); i++)
+        for (int j = 0; j < (int)right.size(); j++) {
+            int w = opType == CUT_V ? left[i].width + right[j].width : max(left[i].width, right[j].width);
+            int h = opType == CUT_V ? max(left[i].height, right[j].height) : left[i].height + right[j].height;
+            candidate.push_back(Node{opType, 0, w, h, left[i].index, i, right[j].index, j});
+        }
+    sort(candidate.begin(), candidate.end(), [](const Node &a, const Node &b) {
+        return a.width != b.width ? a.width < b.width : a.height < b.height;
+    });
+    vector<Node> pruned;
+    int bestH = INT_MAX;
+    for (const Node &c : candidate)
+        if (c.height < bestH) {
+            pruned.push_back(c);
+            bestH = c.height;
+        }
+    sort(pruned.begin(), pruned.end(), [](const Node &a, const Node &b) {
+        return a.height != b.height ? a.height < b.height : a.width < b.width;
+    });
+    out.clear();
+    int bestW = INT_MAX;
+    for (const Node &c : pruned)
+        if (c.width < bestW) {
+            out.push_back(c);
+            bestW = c.width;
+        }
+    reverse(out.begin(), out.end());
+}
+
+int main(int argc, char **argv)
+{
+    int repeat = argc > 1 ? max(1, atoi(argv[1])) : 200;
+    unsigned seed = argc > 2 ? atoi(argv[2]) : 1;
+    mt19937 rng(seed);
+    Floorplanner fp;
+
+    cout << setw(6) << "n" << setw(6) << "op" << setw(14) << "merge (us)" << setw(16) << "cartesian (us)"
+         << setw(10) << "speedup" << setw(8) << "|out|" << endl;
+    for (int n : {2, 4, 8, 16, 32, 64, 128, 256, 512}) {
+        for (int op : {CUT_V, CUT_H}) {
+            vector<vector<Node>> lefts, rights;
+            for (int k = 0; k < 16; k++) {
+                lefts.push_back(randomCurve(rng, 1 + rng() % n, 0));
+                rights.push_back(randomCurve(rng, 1 + rng() % n, 1));
+            }
+            vector<Node> a, b;
+            long long checksum = 0;
+            double t0 = now();
+            for (int r = 0; r < repeat; r++) {
+                fp.stockmeyer(lefts[r % 16], rights[r % 16], op, 2, a);
+                checksum += a.size();
+            }
+            double tMerge = (now() - t0) / repeat;
+            t0 = now();
+            for (int r = 0; r < repeat; r++) {
+                cartesian(lefts[r % 16], rights[r % 16], op, b);
+                checksum -= b.size();
+            }
+            double tCartesian = (now() - t0) / repeat;
+
+            for (int k = 0; k < 16; k++) {
+                fp.stockmeyer(lefts[k], rights[k], op, 2, a);
+                cartesian(lefts[k], rights[k], op, b);
+                bool same = a.size() == b.size();
+                for (size_t i = 0; same && i < a.size(); i++)
+                    same = a[i].width == b[i].width && a[i].height == b[i].height;
+                if (!same || checksum != 0) {
+                    cerr << "[Error] merge and cartesian differ (n = " << n << ")\n";
+                    return 1;
+                }
+            }
+            cout << setw(6) << n << setw(6) << (op == CUT_V ? "V" : "H") << fixed << setprecision(3)
+                 << setw(14) << tMerge * 1e6 << setw(16) << tCartesian * 1e6 << setprecision(1)
+                 << setw(10) << tCartesian / tMerge << setw(8) << a.size() << endl;
+        }
+    }
+    return 0;
+}
@@ -1,11 +1,12 @@
 #include "Floorplanner.h"
+#include "ParallelTempering.h"
 
 int main(int argc, char** argv){
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
     if(argc < 4){
-        cerr << "Usage: " << argv[0] << " <input.txt> <output.out> <dead_space_ratio>\n";
+        cerr << "Usage: " << argv[0] << " <input.txt> <output.out> <dead_space_ratio> [--threads <T>] [--seed <S>]\n";
         return 1;
     }
 
@@ -13,6 +14,27 @@ int main(int argc, char** argv){
     string outFile = argv[2];
     double ds_ratio = atof(argv[3]);
 
+    // --threads T: T >= 2 => parallel tempering (T 個 replica)，0 => 所有 hardware thread
+    // --seed S: 取代 set_seed() 依 testcase 挑的 seed (parallel tempering 的 base seed)
+    int numThreads = 1;
+    bool seedGiven = false;
+    unsigned seed = 0;
+    for(int i = 4; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--threads" && i + 1 < argc)
+            numThreads = atoi(argv[++i]);
+        else if(arg == "--seed" && i + 1 < argc){
+            seed = strtoul(argv[++i], NULL, 10);
+            seedGiven = true;
+        }
+        else {
+            cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+    if(numThreads <= 0)
+        numThreads = max(1u, thread::hardware_concurrency());
+
     // 建立一個 Floorplanner 物件
     Floorplanner fp;
     fp.dead_space_ratio = ds_ratio;
@@ -25,12 +47,17 @@ int main(int argc, char** argv){
     fp.readInput(inFile);
 
     fp.set_seed();
+    if(seedGiven){
+        fp.seed = seed;
+        fp.rng.seed(seed);
+    }
+    ParallelTempering pt(fp, numThreads, fp.seed);
 
     // 2) 計算 Fixed Outline
     fp.calcOutline();
 
     // 第一階段 SA
-    vector<string> expression = fp.initSolution();
+    vector<int> expression = fp.initSolution();
     // for(auto & s : expression){
     //     cout << s << " ";
     // }
@@ -46,12 +73,18 @@ int main(int argc, char** argv){
     {  
         // tie(expression, cost) = fp.simulatedAnnealing(expression, false, 15000, 0.1, 0.9, 10, 1, timer); // second
         // tie(expression, cost) = fp.simulatedAnnealing(expression, false, 15000, 0.1, 0.9, 10, 1, timer); // best
-        tie(expression, cost) = fp.simulatedAnnealing(expression, false, 20000, 0.1, 0.9, 10, 1, timer, AREA_TIME_LIMIT); // for public 3
+        // parallel tempering 每次從上一輪最好的解重新加熱整個 ladder
+        if (numThreads > 1)
+            tie(expression, cost) = pt.run(expression, false, 20000, 0.1, 0.9, 10, timer, AREA_TIME_LIMIT);
+        else
+            tie(expression, cost) = fp.simulatedAnnealing(expression, false, 20000, 0.1, 0.9, 10, 1, timer, AREA_TIME_LIMIT); // for public 3
         printf("Iteration %2d - area cost: %d\n", ++iter, cost);
     }
 
     if (cost != 0)
     {
+        // area 階段只在放進 outline 時才算座標，沒放進去的解在這裡擺一次，輸出至少不會重疊
+        fp.place(expression);
         cout << "No feasible solution is found!\n";
     }else
     {
@@ -71,7 +104,10 @@ int main(int argc, char** argv){
     cout << "------- SA FOR WIRELENGTH -------\n";
     // tie(expression, cost) = fp.simulatedAnnealing(expression, true, 1000, 1, 0.95, 5, 1, timer); // second
     // tie(expression, cost) = fp.simulatedAnnealing(expression, true, 1000, 1, 0.95, 10, 1, timer); // best
-    tie(expression, cost) = fp.simulatedAnnealing(expression, true, 1000, 1, 0.95, 10, 1, timer, remaining); //  for public 3
+    if (numThreads > 1)
+        tie(expression, cost) = pt.run(expression, true, 1000, 1, 0.95, 10, timer, remaining);
+    else
+        tie(expression, cost) = fp.simulatedAnnealing(expression, true, 1000, 1, 0.95, 10, 1, timer, remaining); //  for public 3
     fp.blocks = fp.best_blocks;
     wirelength = fp.getWirelength();
     cout << "A minimum wirelength solution is found!\n"